@@ -4,7 +4,10 @@
 #include "IRenderer.h"
 #include "IMesh.h"
 #include "ecs/Coordinator.h"
+#include "ecs/CommandBuffer.h"
+#include "ecs/Scheduler.h"
 #include "ecs/systems/DemoSystems.h"
+#include "ecs/systems/HierarchySystem.h"
 
 namespace app {
 
@@ -16,8 +19,11 @@ namespace app {
 		~DemoECSLayer() override = default;
 
 		void OnAttach() override;
+		void OnEvent(core::Event& event) override;
 		void OnUpdate(float deltaTime) override;
-		void OnRender() override;
+		void OnExtract() override;
+		void OnRenderSync() override;
+		void OnRender(float alpha) override;
 
 	private:
 
@@ -28,6 +34,20 @@ namespace app {
 		ecs::Coordinator m_Coordinator{};
 		std::shared_ptr<ecs::MovementSystem> m_MoveSystem{};
 		std::shared_ptr<ecs::RenderSystem>   m_RenderSystem{};
+		std::shared_ptr<ecs::HierarchySystem> m_HierarchySystem{};
+
+		// Spinning hub carrying arms, each with a cube orbiting its tip
+		ecs::Entity m_Hub = ecs::NULL_ENTITY;
+		std::vector<ecs::Entity> m_Arms{};
+		float m_HubAngle = 0.0f;
+
+		// Structural changes requested during the update, applied after it
+		ecs::CommandBuffer m_Commands{};
+
+		// Runs the update systems on the job system, see OnAttach
+		ecs::Scheduler m_Scheduler{};
+		bool m_PrintReport = false;
+		float m_ReportTime = 0.0f;
 
 		// Camera
 		DirectX::XMMATRIX m_View{};
@@ -35,6 +55,9 @@ namespace app {
 
 		// Shader
 		std::shared_ptr<gfx::IShaderClass> m_Shader{};
+
+		// Render packets borrow the mesh, it lives as long as the layer
+		std::shared_ptr<gfx::IMesh> m_Mesh{};
 	};
 
 }
\ No newline at end of file
@@ -1,7 +1,12 @@
 #include "DemoECSLayer.h"
 #include "TestMeshCube.h"
 #include "DX11ShaderClass.h"
+#include "core/Engine.h"
+#include "core/Key_Defines.h"
+#include "core/events/KeyEvent.h"
+#include <Windows.h>
 #include <random>
+#include <vector>
 #include <filesystem>
 
 app::DemoECSLayer::DemoECSLayer(gfx::IRenderer* renderer)
@@ -13,34 +18,47 @@ void app::DemoECSLayer::OnAttach()
 {
 	//m_Cube = std::make_unique<gfx::TestMeshCube>();
 	//m_Cube->Create(m_Renderer);
-	m_Coordinator.Init();
+	// Switch to ecs::StorageBackend::Archetype to compare the two layouts
+	m_Coordinator.Init(ecs::StorageBackend::SparseSet);
 	m_Coordinator.RegisterComponent<ecs::Transform>();
 	m_Coordinator.RegisterComponent<ecs::Velocity>();
 	m_Coordinator.RegisterComponent<ecs::Color>();
 	m_Coordinator.RegisterComponent<ecs::MeshComponent>();
+	m_Coordinator.RegisterComponent<ecs::WorldMatrix>();
+	m_Coordinator.RegisterComponent<ecs::Parent>();
+	m_Coordinator.RegisterComponent<ecs::Children>();
+	m_Coordinator.RegisterComponent<ecs::LocalTransform>();
+	m_Coordinator.RegisterComponent<ecs::WorldTransform>();
+
+	// Movement reads exactly these two: keep their arrays co-sorted
+	m_Coordinator.RegisterGroup<ecs::Transform, ecs::Velocity>();
 
 	// Movement system
 	m_MoveSystem = m_Coordinator.RegisterSystem<ecs::MovementSystem>();
 	{
-		std::bitset<ecs::MAX_COMPONENTS> sig;
-		sig.set(m_Coordinator.GetComponentType<ecs::Transform>());
-		sig.set(m_Coordinator.GetComponentType<ecs::Velocity>());
+		constexpr ecs::Signature sig = ecs::MakeSignature<ecs::Transform, ecs::Velocity>();
 		m_Coordinator.SetSystemSignature<ecs::MovementSystem>(sig);
 	}
 
 	// Render system
 	m_RenderSystem = m_Coordinator.RegisterSystem<ecs::RenderSystem>();
 	{
-		std::bitset<ecs::MAX_COMPONENTS> sig; sig;
-		sig.set(m_Coordinator.GetComponentType<ecs::Transform>());
-		sig.set(m_Coordinator.GetComponentType<ecs::Color>());
-		sig.set(m_Coordinator.GetComponentType<ecs::MeshComponent>());
+		// What a packet is made of: the cubes and the hierarchy nodes alike, Transform or not
+		constexpr ecs::Signature sig = ecs::MakeSignature<ecs::WorldMatrix, ecs::Color, ecs::MeshComponent>();
 		m_Coordinator.SetSystemSignature<ecs::RenderSystem>(sig);
 	}
 
+	// Hierarchy system
+	m_HierarchySystem = m_Coordinator.RegisterSystem<ecs::HierarchySystem>();
+	{
+		constexpr ecs::Signature sig = ecs::MakeSignature<ecs::LocalTransform, ecs::WorldTransform>();
+		m_Coordinator.SetSystemSignature<ecs::HierarchySystem>(sig);
+	}
+
 	// --- Mesh e shader ---
 	auto mesh = std::make_shared<gfx::TestMeshCube>();
 	mesh->Create(m_Renderer);
+	m_Mesh = mesh;
 
 	m_Shader = m_Renderer->CreateShader(
 		L"C:/Develop/archECS/RenderCore/assets/shaders/simple_lit_vs.hlsl",
@@ -63,33 +81,144 @@ void app::DemoECSLayer::OnAttach()
 
 
 	const int numCubes = 2000;
+	const std::vector<ecs::Entity> entities = m_Coordinator.CreateEntities(numCubes);
+
+	std::vector<ecs::Transform> transforms;
+	std::vector<ecs::Velocity> velocities;
+	std::vector<ecs::Color> colors;
+	std::vector<ecs::MeshComponent> meshes(numCubes, ecs::MeshComponent{ mesh });
+	std::vector<ecs::WorldMatrix> worlds(numCubes);
+	transforms.reserve(numCubes);
+	velocities.reserve(numCubes);
+	colors.reserve(numCubes);
+
 	for (int i = 0; i < numCubes; ++i)
 	{
-		auto e = m_Coordinator.CreateEntity();
-
 		DirectX::XMFLOAT3 pos{ distPos(rng), distPos(rng) * 0.3f, distPos(rng) };
 		DirectX::XMFLOAT3 rot{ 0.0f, distPos(rng) * 0.5f, 0.0f };
 		DirectX::XMFLOAT3 scl{ 0.5f, 0.5f, 0.5f };
 
-		m_Coordinator.AddComponent(e, ecs::Transform{ pos, rot, scl });
-		m_Coordinator.AddComponent(e, ecs::Velocity{ distVel(rng), distPos(rng) });
-		m_Coordinator.AddComponent(e, ecs::Color{
+		transforms.push_back(ecs::Transform{ pos, rot, scl });
+		velocities.push_back(ecs::Velocity{ distVel(rng), distPos(rng) });
+		colors.push_back(ecs::Color{
 			{ distCol(rng), distCol(rng) * 0.8f, distCol(rng), 1.0f }
 			});
-		m_Coordinator.AddComponent(e, ecs::MeshComponent{ mesh });
 	}
+
+	// One batched insertion per component type, one system pass for the whole batch
+	m_Coordinator.AddComponents<ecs::Transform, ecs::Velocity, ecs::Color, ecs::MeshComponent, ecs::WorldMatrix>(
+		entities, transforms, velocities, colors, meshes, worlds);
+
+	// --- Spawn hierarchy ---
+	// Every node starts as a copy of the same prefab, then gets its own values
+	ecs::Prefab node;
+	node.Set(ecs::LocalTransform{})
+		.Set(ecs::WorldTransform{})
+		.Set(ecs::Color{})
+		.Set(ecs::MeshComponent{ mesh })
+		.Set(ecs::WorldMatrix{});
+
+	auto spawnNode = [&](const adg::Vector3& position, adg::Scalar scale, const DirectX::XMFLOAT4& color) {
+
+		ecs::Entity entity = m_Coordinator.Instantiate(node);
+
+		ecs::LocalTransform& local = m_Coordinator.GetComponent<ecs::LocalTransform>(entity);
+		local.value.translation = position;
+		local.value.scale = scale;
+
+		m_Coordinator.GetComponent<ecs::Color>(entity).value = color;
+		return entity;
+	};
+
+	m_Hub = spawnNode(adg::Vector3(15.0f, 4.0f, 15.0f), 1.5f, { 1.0f, 0.9f, 0.3f, 1.0f });
+
+	const int numArms = 6;
+	for (int i = 0; i < numArms; ++i)
+	{
+		const float angle = DirectX::XM_2PI * i / numArms;
+
+		// Positions are in the parent's space, scaled by the parent's scale
+		ecs::Entity arm = spawnNode(adg::Vector3(3.0f * cosf(angle), 0.0f, 3.0f * sinf(angle)), 0.5f, { 0.3f, 0.7f, 1.0f, 1.0f });
+		ecs::Entity tip = spawnNode(adg::Vector3(0.0f, 0.0f, 3.0f), 0.6f, { 1.0f, 0.4f, 0.4f, 1.0f });
+
+		m_HierarchySystem->SetParent(m_Coordinator, arm, m_Hub);
+		m_HierarchySystem->SetParent(m_Coordinator, tip, arm);
+		m_Arms.push_back(arm);
+	}
+
+	// --- Frame schedule ---
+	// Movement shares no component with the hub and the hierarchy, so it runs alongside them
+	m_Scheduler.Add<ecs::MovementSystem>("Movement", [this](ecs::SystemContext& context) {
+		m_MoveSystem->Update(context.coordinator, context.jobs, context.deltaTime);
+	});
+
+	m_Scheduler.Add("HubSpin", ecs::SystemAccess::Of<ecs::LocalTransform>(), [this](ecs::SystemContext& context) {
+		// Only the hub and the arms spin, the tips follow through the hierarchy
+		m_HubAngle += 30.0f * context.deltaTime;
+		context.coordinator.GetComponent<ecs::LocalTransform>(m_Hub).value.rotation = adg::axisAngleToQuaternion(adg::Vector3::up(), m_HubAngle);
+
+		for (ecs::Entity arm : m_Arms)
+			context.coordinator.GetComponent<ecs::LocalTransform>(arm).value.rotation = adg::axisAngleToQuaternion(adg::Vector3::up(), -3.0f * m_HubAngle);
+	});
+
+	m_Scheduler.Add<ecs::HierarchySystem>("Hierarchy", [this](ecs::SystemContext& context) {
+		m_HierarchySystem->Update(context.coordinator);
+	});
 }
 
 void app::DemoECSLayer::OnUpdate(float deltaTime)
 {
 	//m_Cube->LoadBuffersOnGPU();
-	m_MoveSystem->Update(m_Coordinator, deltaTime);
+	m_RenderSystem->BeginStep(m_Coordinator);
+	m_Scheduler.Run(m_Coordinator, core::Engine::GetInstance().GetJobSystem(), deltaTime);
+
+	// Sync point: no system is iterating anymore
+	m_Commands.Flush(m_Coordinator);
+	m_Coordinator.FlushObservers();
+
+	// Critical path of the frame to the debugger output, every few seconds, toggled with F3
+	if (!m_PrintReport)
+		return;
+
+	m_ReportTime += deltaTime;
+	if (m_ReportTime >= 5.0f)
+	{
+		m_ReportTime = 0.0f;
+		OutputDebugStringA(m_Scheduler.GetReport().Format().c_str());
+	}
+}
+
+void app::DemoECSLayer::OnEvent(core::Event& event)
+{
+	core::EventDispatcher dispatcher(event);
+	dispatcher.Dispatch<core::KeyPressedEvent>([this](core::KeyPressedEvent& key) {
+
+		if (key.GetKeyCode() != KDEF_F3 || key.IsRepeat())
+			return false;
+
+		m_PrintReport = !m_PrintReport;
+		m_ReportTime = 0.0f;
+		return true;
+	});
+}
+
+void app::DemoECSLayer::OnExtract()
+{
+	m_RenderSystem->Extract(m_Coordinator);
+
+	// Whatever changes before the next step compares newer than what Extract saw
+	m_Coordinator.AdvanceTick();
+}
+
+void app::DemoECSLayer::OnRenderSync()
+{
+	m_RenderSystem->SwapPackets();
 }
 
-void app::DemoECSLayer::OnRender()
+void app::DemoECSLayer::OnRender(float alpha)
 {
 	// render all
 	// m_Renderer->BeginFrame(0.5, 0.5, 0.5, 1);
 	// m_Renderer->PresentFrame();
-	m_RenderSystem->Update(m_Coordinator);
+	m_RenderSystem->Draw(alpha);
 }
@@ -4,6 +4,12 @@
 int main(int argc, char** argv)
 {
 	core::Engine engine;
+
+	// Simulation at 60 Hz, rendering as fast as the display allows
+	core::TimestepSpecs timestep;
+	timestep.mode = core::TimestepMode::Fixed;
+	engine.SetTimestep(timestep);
+
 	engine.AddLayerToStack<app::DemoECSLayer>(engine.GetRenderer());
 
 	engine.Start();
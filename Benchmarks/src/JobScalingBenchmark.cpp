@@ -0,0 +1,142 @@
+/// --------------------------------------------------------------
+/// Job System Scaling Benchmark
+/// --------------------------------------------------------------
+/// Headless ECS workload (no window, no renderer) run with 1 to N
+/// threads on the JobSystem, printing the frame time and the speedup
+/// over the single-threaded run. The update goes through
+/// Coordinator::ParallelForEach. Every run starts from the same state,
+/// so the checksums must match.
+///
+///		Benchmarks.exe [entities] [frames] [max threads]
+
+#include "core/jobs/JobSystem.h"
+#include "ecs/Coordinator.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace bench {
+
+	struct Body {
+		float x = 0.0f, y = 0.0f, z = 0.0f;
+		float vx = 0.0f, vy = 0.0f, vz = 0.0f;
+	};
+
+	struct Orbit {
+		float angle = 0.0f;
+		float speed = 1.0f;
+		float radius = 1.0f;
+	};
+
+	struct OrbitSystem : ecs::System {};
+}
+
+ECS_COMPONENT(bench::Body, 0)
+ECS_COMPONENT(bench::Orbit, 1)
+ECS_SYSTEM(bench::OrbitSystem, 0)
+
+namespace {
+
+	// Enough math per entity that the run is bound by the cores, not by memory
+	constexpr int SUBSTEPS = 16;
+
+	void Update(bench::Body& body, bench::Orbit& orbit, float dt)
+	{
+		const float h = dt / SUBSTEPS;
+
+		for (int s = 0; s < SUBSTEPS; ++s)
+		{
+			orbit.angle += orbit.speed * h;
+
+			const float tx = orbit.radius * std::cos(orbit.angle);
+			const float tz = orbit.radius * std::sin(orbit.angle);
+
+			body.vx += (tx - body.x) * h;
+			body.vz += (tz - body.z) * h;
+			body.vy -= body.y * h;
+
+			body.x += body.vx * h;
+			body.y += body.vy * h;
+			body.z += body.vz * h;
+		}
+	}
+
+	double Checksum(ecs::Coordinator& coordinator, const ecs::EntitySet& entities)
+	{
+		double sum = 0.0;
+		for (ecs::Entity entity : entities)
+			sum += coordinator.GetComponent<const bench::Body>(entity).x;
+		return sum;
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const std::size_t entityCount = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+	const int frames = argc > 2 ? std::atoi(argv[2]) : 60;
+	const std::uint32_t maxThreads = argc > 3 ? std::max(1, std::atoi(argv[3])) : std::max(1u, std::thread::hardware_concurrency());
+
+	ecs::Coordinator coordinator;
+	coordinator.Init(ecs::StorageBackend::SparseSet);
+	coordinator.RegisterComponent<bench::Body>();
+	coordinator.RegisterComponent<bench::Orbit>();
+
+	// The update writes both, a group keeps them in the same order for the parallel cut
+	coordinator.RegisterGroup<bench::Body, bench::Orbit>();
+
+	auto system = coordinator.RegisterSystem<bench::OrbitSystem>();
+	coordinator.SetSystemSignature<bench::OrbitSystem>(ecs::MakeSignature<bench::Body, bench::Orbit>());
+
+	const std::vector<ecs::Entity> entities = coordinator.CreateEntities(entityCount);
+	std::vector<bench::Body> bodies(entityCount);
+	std::vector<bench::Orbit> orbits(entityCount);
+
+	for (std::size_t i = 0; i < entityCount; ++i)
+	{
+		orbits[i].angle = 0.001f * float(i);
+		orbits[i].speed = 0.5f + float(i % 7) * 0.25f;
+		orbits[i].radius = 1.0f + float(i % 13);
+	}
+
+	coordinator.AddComponents<bench::Body, bench::Orbit>(entities, bodies, orbits);
+
+	std::printf("%zu entities, %d frames, up to %u threads\n\n", entityCount, frames, maxThreads);
+	std::printf("threads   ms/frame   speedup   checksum\n");
+
+	double baseline = 0.0;
+
+	for (std::uint32_t threads = 1; threads <= maxThreads; ++threads)
+	{
+		core::JobSystem jobs(threads - 1);
+		const float dt = 1.0f / 60.0f;
+
+		for (std::size_t i = 0; i < entityCount; ++i)
+		{
+			coordinator.GetComponent<bench::Body>(entities[i]) = bodies[i];
+			coordinator.GetComponent<bench::Orbit>(entities[i]) = orbits[i];
+		}
+
+		auto frame = [&] {
+			coordinator.ParallelForEach<bench::Body, bench::Orbit>(jobs, [dt](ecs::Entity, bench::Body& body, bench::Orbit& orbit) {
+				Update(body, orbit, dt);
+			});
+		};
+
+		const auto start = std::chrono::steady_clock::now();
+		for (int f = 0; f < frames; ++f)
+			frame();
+		const auto stop = std::chrono::steady_clock::now();
+
+		const double ms = std::chrono::duration<double, std::milli>(stop - start).count() / frames;
+		if (threads == 1)
+			baseline = ms;
+
+		std::printf("%7u   %8.3f   %6.2fx   %.3f\n", threads, ms, baseline / ms, Checksum(coordinator, system->m_Entities));
+	}
+
+	return 0;
+}
@@ -0,0 +1,29 @@
+/// DoubleBuffer
+/// Two copies of the data handed from one thread to another: the
+/// producer fills the back one while the consumer reads the front one,
+/// and Swap() exchanges them at a point where neither side touches them.
+///
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace core {
+
+	template<typename T>
+	class DoubleBuffer {
+
+	public:
+
+		T& Back() { return m_Buffers[m_Front ^ 1]; }
+		const T& Front() const { return m_Buffers[m_Front]; }
+
+		void Swap() { m_Front ^= 1; }
+
+	private:
+
+		std::array<T, 2> m_Buffers{};
+		uint32_t m_Front = 0;
+	};
+}
@@ -5,9 +5,12 @@
 #pragma once
 
 #include <memory>
+#include <cstdint>
 #include "core\IWindow.h"
 #include "core\ITimer.h"
 #include "core\LayerStack.h"
+#include "core\jobs\JobSystem.h"
+#include "core\RenderThread.h"
 #include "IRenderer.h"
 
 namespace core {
@@ -15,6 +18,21 @@ namespace core {
 	class WindowCloseEvent;
 	class KeyPressedEvent;
 
+	/// How Run() steps the layers
+	/// Variable - one OnUpdate per rendered frame, with the frame time
+	/// Fixed    - OnUpdate with fixedDeltaTime, as many times as the elapsed time asks for
+	enum class TimestepMode { Variable, Fixed };
+
+	struct TimestepSpecs {
+
+		TimestepMode mode = TimestepMode::Variable;
+		float fixedDeltaTime = 1.0f / 60.0f;
+
+		// Catch-up limit: time beyond that many steps in a frame is dropped,
+		// so that a slow frame can't ask for ever more steps (spiral of death)
+		uint32_t maxStepsPerFrame = 5;
+	};
+
 	class Engine {
 
 	public:
@@ -43,18 +61,39 @@ namespace core {
 		/** Returns the reference to the Window */
 		IWindow& GetWindow() { return *m_Window; }
 
+		/** Thread pool for the layers' parallel work */
+		JobSystem& GetJobSystem() { return *m_JobSystem; }
+
+		/// In Fixed mode the simulation runs in fixedDeltaTime steps whatever
+		/// the frame rate, and OnRender gets how far the time is between the
+		/// last step and the next one (alpha), to interpolate the two states.
+		void SetTimestep(const TimestepSpecs& specs);
+		const TimestepSpecs& GetTimestep() const { return m_Timestep; }
+
 	private:
 
 		static Engine* s_Engine;
 
 		bool m_Running = false;
 
+		// Declared before the layers so that it outlives them
+		std::unique_ptr<JobSystem> m_JobSystem{};
+
 		LayerStack m_LayerStack{};
 		std::unique_ptr<IWindow> m_Window{};     // for now handling one window at a time
 		std::unique_ptr<gfx::IRenderer> m_Renderer{};
 		std::unique_ptr<ITimer> m_Timer{};
 
+		// Declared after the layers and the renderer it draws with, so it stops first
+		std::unique_ptr<RenderThread> m_RenderThread{};
+
+		TimestepSpecs m_Timestep{};
+		double m_Accumulator = 0.0;     // simulation time owed, Fixed mode
+
 		void Run();
+
+		/** Steps the layers' OnUpdate for the frame time, returns the interpolation alpha */
+		float Update(float frameTime);
 		void Shutdown();
 
 		bool OnWindowClose(WindowCloseEvent& e);
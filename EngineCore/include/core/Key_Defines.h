@@ -21,3 +21,4 @@ namespace core::key {
 #define KDEF_CANCEL         0x03
 #define KDEF_MBUTTON        0x04    /* NOT contiguous with L & RBUTTON */
 #define KDEF_ESCAPE         0x1B
+#define KDEF_F3             0x72
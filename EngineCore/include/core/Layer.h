@@ -30,7 +30,24 @@ namespace core {
 		virtual void OnEvent(Event& event) {}
 
 		virtual void OnUpdate(float deltaTime) {}
-		virtual void OnRender() {}
+
+		/// Main thread, after the frame's updates, while the render thread
+		/// may still be drawing the previous frame: copy what OnRender needs
+		/// out of the simulation, into storage OnRender isn't reading (the
+		/// back side of a DoubleBuffer).
+		virtual void OnExtract() {}
+
+		/// Main thread, the render thread is idle: hand over what OnExtract
+		/// prepared (swap the buffers). Keep it short, nothing overlaps it.
+		virtual void OnRenderSync() {}
+
+		/// Render thread, concurrently with the next frame's OnUpdate: only
+		/// read what OnExtract prepared, never the live simulation.
+		/// alpha is where the frame falls between the last simulation step
+		/// and the next one, in [0, 1): with a fixed timestep, render the
+		/// state interpolated from the previous step by alpha. Always 1
+		/// with a variable timestep.
+		virtual void OnRender(float alpha) {}
 
 		const std::string& GetName() const { return m_debugName; }
 
@@ -0,0 +1,59 @@
+/// RenderThread
+/// Runs the draw submission of a frame on its own thread, so that
+/// it overlaps the simulation of the next frame (see Engine::Run).
+///
+
+#pragma once
+
+#include <thread>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace core {
+
+	class RenderThread {
+
+	public:
+
+		using RenderFunction = std::function<void(float alpha)>;
+		using PumpFunction = std::function<void()>;
+
+		explicit RenderThread(RenderFunction render);
+
+		/** Lets the frame in flight finish, then stops the thread */
+		~RenderThread();
+
+		RenderThread(const RenderThread&) = delete;
+		RenderThread& operator=(const RenderThread&) = delete;
+
+		/** Starts drawing a frame, after Wait() for the previous one */
+		void Kick(float alpha);
+
+		/// Blocks until the frame in flight is drawn, returns at once if there is none.
+		/// pump runs on the waiting thread every PUMP_INTERVAL meanwhile. Pass the
+		/// window's message pump when waiting on the thread that owns the window:
+		/// Present may block until that thread handles a message (resize,
+		/// fullscreen switch), which it would never do while blocked here.
+		void Wait(const PumpFunction& pump = {});
+
+	private:
+
+		static constexpr std::chrono::milliseconds PUMP_INTERVAL{ 1 };
+
+		RenderFunction m_Render;
+
+		std::mutex m_Mutex;
+		std::condition_variable m_Kicked;
+		std::condition_variable m_Drawn;
+		bool m_Pending = false;
+		bool m_Exit = false;
+		float m_Alpha = 1.0f;
+
+		// Started last, once the state above exists
+		std::thread m_Thread;
+
+		void Loop();
+	};
+}
@@ -0,0 +1,162 @@
+/// JobSystem
+/// Work-stealing thread pool shared by the engine and its layers.
+/// Reach it with Engine::GetInstance().GetJobSystem().
+///
+
+#pragma once
+
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include "core/jobs/WorkStealingQueue.h"
+
+namespace core {
+
+	using Job = std::function<void()>;
+
+	/// Tracks a group of jobs: every job run with a counter keeps it
+	/// pending until the job returns. Waiting on a counter is how a job
+	/// (or the frame) depends on others:
+	///
+	///		core::JobCounter physics;
+	///		jobs.Run([&] { StepBodies(); }, physics);
+	///		jobs.Run([&] { StepCloth(); }, physics);
+	///		jobs.Wait(physics);
+	///
+	/// A counter must outlive the jobs it counts, and can be reused once done.
+
+	class JobCounter
+	{
+	public:
+
+		JobCounter() = default;
+		JobCounter(const JobCounter&) = delete;
+		JobCounter& operator=(const JobCounter&) = delete;
+
+		bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+	private:
+
+		friend class JobSystem;
+
+		std::atomic<std::uint32_t> m_Pending{ 0 };
+	};
+
+	/// Each thread owns a deque (see WorkStealingQueue): jobs go to the deque
+	/// of the thread that runs them, and threads that run out of work steal
+	/// from the others. The thread that creates the JobSystem owns deque 0
+	/// and takes part in the work whenever it waits, so a system with N
+	/// workers runs jobs on N + 1 threads.
+	///
+	/// Idle workers keep spinning for spinTime before going to sleep: with
+	/// the default, a bit longer than a 60 Hz frame, they stay hot from one
+	/// frame to the next and never wait on the OS to wake up while the game
+	/// loop runs. Threads other than the workers and the creator can run and
+	/// wait on jobs too, they share deque 0.
+
+	class JobSystem
+	{
+	public:
+
+		static constexpr std::chrono::microseconds DEFAULT_SPIN_TIME{ 20000 };
+
+		explicit JobSystem(std::uint32_t workerCount = DefaultWorkerCount(0),
+			std::chrono::microseconds spinTime = DEFAULT_SPIN_TIME);
+		~JobSystem();
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		/** Queues a job on the calling thread's deque */
+		void Run(Job job, JobCounter& counter);
+
+		/** Runs queued jobs (anyone's) until the counter's jobs are done */
+		void Wait(JobCounter& counter);
+
+		/// Calls func(begin, end) over [0, count) split in batches of at least
+		/// minBatch items, and returns when every batch is done. There are a
+		/// few batches per thread so that stealing evens out uneven work; the
+		/// calling thread runs the first one itself.
+		///
+		///		jobs.ParallelFor(particles.size(), 256, [&](std::size_t begin, std::size_t end) { ... });
+		template<typename Func>
+		void ParallelFor(std::size_t count, std::size_t minBatch, Func&& func);
+
+		/** Threads that run jobs: the workers plus the creator */
+		std::uint32_t GetThreadCount() const { return static_cast<std::uint32_t>(m_Queues.size()); }
+
+		/// One worker per hardware thread besides the creator's and otherThreads
+		/// more that stay busy without running jobs (a render thread): idle
+		/// workers spin, they must not compete with those for a core.
+		static std::uint32_t DefaultWorkerCount(std::uint32_t otherThreads = 0);
+
+	private:
+
+		struct QueuedJob
+		{
+			Job function;
+			JobCounter* counter = nullptr;
+		};
+
+		// Indexed by thread: 0 for the creator, 1..N for the workers
+		std::vector<std::unique_ptr<WorkStealingQueue<QueuedJob>>> m_Queues{};
+		std::vector<std::thread> m_Workers{};
+
+		std::chrono::microseconds m_SpinTime;
+		std::atomic<bool> m_Running{ true };
+
+		// Jobs sitting in any deque, lets idle threads skip a scan for nothing
+		std::atomic<std::uint32_t> m_QueuedJobs{ 0 };
+
+		std::atomic<std::uint32_t> m_SleepingWorkers{ 0 };
+		std::mutex m_SleepMutex;
+		std::condition_variable m_WakeUp;
+
+		void WorkerLoop(std::uint32_t index);
+
+		/** Runs one job from the thread's deque or stolen from another, false if there was none */
+		bool RunOne(std::uint32_t index);
+
+		/** Deque of the calling thread */
+		std::uint32_t GetQueueIndex() const;
+	};
+
+	/// ----------------------------------------------
+	/// ParallelFor
+	/// ----------------------------------------------
+
+	template<typename Func>
+	inline void JobSystem::ParallelFor(std::size_t count, std::size_t minBatch, Func&& func)
+	{
+		if (count == 0)
+			return;
+
+		const std::size_t batchesWanted = std::size_t(GetThreadCount()) * 4;
+		const std::size_t batch = std::max<std::size_t>(std::max<std::size_t>(minBatch, 1), (count + batchesWanted - 1) / batchesWanted);
+
+		if (batch >= count)
+		{
+			func(std::size_t(0), count);
+			return;
+		}
+
+		JobCounter counter;
+
+		for (std::size_t begin = batch; begin < count; begin += batch)
+		{
+			const std::size_t end = std::min(count, begin + batch);
+			Run([&func, begin, end] { func(begin, end); }, counter);
+		}
+
+		func(std::size_t(0), batch);
+		Wait(counter);
+	}
+}
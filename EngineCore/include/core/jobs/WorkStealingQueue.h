@@ -0,0 +1,59 @@
+#pragma once
+
+#include <deque>
+#include <mutex>
+#include <utility>
+
+namespace core {
+
+	/// Per-thread job deque of the JobSystem.
+	///
+	/// The owning thread pushes and pops at the back (LIFO: the job it just
+	/// made is the one most likely to find its data in cache), while idle
+	/// threads steal from the front, taking the oldest and usually largest
+	/// pieces of work. Every queue has its own lock, so threads only meet
+	/// when one of them is stealing, and then only on that queue.
+
+	template<typename T>
+	class WorkStealingQueue
+	{
+	public:
+
+		void Push(T item)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+			m_Items.push_back(std::move(item));
+		}
+
+		/** Owner side: takes the most recent item */
+		bool Pop(T& out)
+		{
+			std::lock_guard<std::mutex> lock(m_Mutex);
+
+			if (m_Items.empty())
+				return false;
+
+			out = std::move(m_Items.back());
+			m_Items.pop_back();
+			return true;
+		}
+
+		/** Thief side: takes the oldest item, gives up if the owner holds the lock */
+		bool Steal(T& out)
+		{
+			std::unique_lock<std::mutex> lock(m_Mutex, std::try_to_lock);
+
+			if (!lock.owns_lock() || m_Items.empty())
+				return false;
+
+			out = std::move(m_Items.front());
+			m_Items.pop_front();
+			return true;
+		}
+
+	private:
+
+		std::mutex m_Mutex;
+		std::deque<T> m_Items;
+	};
+}
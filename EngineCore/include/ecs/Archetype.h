@@ -0,0 +1,126 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <new>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+#include "ecs/Entity.h"
+#include "ecs/Component.h"
+#include "ecs/Signature.h"
+
+namespace ecs {
+
+	// -----------------------------------------
+	// Chunk
+	// -----------------------------------------
+
+	/// A fixed-size block of memory holding a slice of the entities of
+	/// one archetype. The block is laid out column by column: first the
+	/// entity IDs, then one tightly packed array per component type.
+
+	struct Chunk
+	{
+		static constexpr std::size_t SIZE = 16 * 1024;
+		static constexpr std::size_t ALIGNMENT = 64;
+
+		std::byte* data = nullptr;
+		std::uint32_t count = 0;
+	};
+
+	// -----------------------------------------
+	// Archetype
+	// -----------------------------------------
+
+	/// An Archetype stores every entity that has exactly the same signature.
+	/// Rows are packed: every chunk but the last one is full, and removing
+	/// a row moves the last row into the hole to keep it that way.
+	/// Change ticks are tracked per chunk and column: a chunk column is
+	/// stamped when any of its rows is written, added or moved in.
+
+	class Archetype
+	{
+	public:
+
+		static constexpr std::uint32_t INVALID_COLUMN = UINT32_MAX;
+
+		Archetype(const Signature& signature,
+			const std::array<ComponentInfo, MAX_COMPONENTS>& componentInfos);
+		~Archetype();
+
+		Archetype(const Archetype&) = delete;
+		Archetype& operator=(const Archetype&) = delete;
+
+		const Signature& GetSignature() const { return m_Signature; }
+		std::size_t GetEntityCount() const { return m_EntityCount; }
+		std::uint32_t GetChunkCapacity() const { return m_ChunkCapacity; }
+
+		/** Chunk access */
+		std::size_t GetChunkCount() const { return m_Chunks.size(); }
+		Chunk& GetChunk(std::size_t index) { return m_Chunks[index]; }
+
+		/** Column access */
+		std::uint32_t GetColumnCount() const { return static_cast<std::uint32_t>(m_Columns.size()); }
+		std::uint32_t GetColumn(ComponentType type) const { return m_ColumnOfType[type]; }
+		ComponentType GetColumnType(std::uint32_t column) const { return m_Columns[column].type; }
+		const ComponentInfo& GetColumnInfo(std::uint32_t column) const { return m_Columns[column].info; }
+
+		/** Last modification tick of a column in a chunk */
+		Tick GetChangeTick(std::size_t chunk, std::uint32_t column) const { return m_ChangeTicks[chunk * m_Columns.size() + column]; }
+		void SetChangeTick(std::size_t chunk, std::uint32_t column, Tick tick) { m_ChangeTicks[chunk * m_Columns.size() + column] = tick; }
+
+		/** Stamps every column of the chunk holding the row */
+		void MarkRowChanged(std::uint32_t row, Tick tick);
+
+		Entity* GetEntities(Chunk& chunk) { return reinterpret_cast<Entity*>(chunk.data); }
+		void* GetColumnData(Chunk& chunk, std::uint32_t column) { return chunk.data + m_Columns[column].offset; }
+
+		/** Pointer to the component of a column stored in a row */
+		void* GetComponentData(std::uint32_t row, std::uint32_t column)
+		{
+			Chunk& chunk = m_Chunks[row / m_ChunkCapacity];
+			return static_cast<std::byte*>(GetColumnData(chunk, column))
+				+ static_cast<std::size_t>(row % m_ChunkCapacity) * m_Columns[column].info.size;
+		}
+
+		/** Appends a row for the entity, component slots are left for the caller to construct */
+		std::uint32_t PushEntity(Entity entity);
+
+		/// Removes a row by moving the last row into it.
+		/// If destroyComponents is false the row's components must already
+		/// have been moved-from and destroyed by the caller.
+		/// Returns the entity that now occupies the row (the removed one if it was the last).
+		Entity RemoveRow(std::uint32_t row, bool destroyComponents);
+
+		/** Cached transitions to the archetype with one more/less component */
+		Archetype*& AddEdge(ComponentType type) { return m_AddEdges[type]; }
+		Archetype*& RemoveEdge(ComponentType type) { return m_RemoveEdges[type]; }
+
+	private:
+
+		struct Column
+		{
+			ComponentType type;
+			std::size_t offset;
+			ComponentInfo info;
+		};
+
+		Signature m_Signature{};
+		std::vector<Column> m_Columns{};
+		std::array<std::uint32_t, MAX_COMPONENTS> m_ColumnOfType{};
+
+		std::vector<Chunk> m_Chunks{};
+		std::uint32_t m_ChunkCapacity = 0;
+		std::size_t m_EntityCount = 0;
+
+		// Indexed by chunk * column count + column
+		std::vector<Tick> m_ChangeTicks{};
+
+		std::array<Archetype*, MAX_COMPONENTS> m_AddEdges{};
+		std::array<Archetype*, MAX_COMPONENTS> m_RemoveEdges{};
+
+		void ReleaseUnusedChunks();
+	};
+}
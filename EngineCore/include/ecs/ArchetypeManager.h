@@ -0,0 +1,422 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <span>
+#include <unordered_map>
+#include <cassert>
+#include "ecs/Entity.h"
+#include "ecs/Component.h"
+#include "ecs/Signature.h"
+#include "ecs/Archetype.h"
+#include "ecs/PagedArray.h"
+#include "ecs/EntitySet.h"
+#include "ecs/Prefab.h"
+#include "ecs/Parallel.h"
+
+namespace ecs {
+
+	// -----------------------------------------
+	// Archetype Manager
+	// -----------------------------------------
+
+	/// Alternative storage engine to the per-type ComponentArrays.
+	/// Entities sharing the same signature live together in the chunks of
+	/// one Archetype, so iterating a set of components streams through
+	/// contiguous columns instead of doing one lookup per component.
+	/// Adding or removing a component moves the entity to another archetype.
+	/// Tag components never reach this storage, archetypes only hold data.
+
+	class ArchetypeManager {
+
+	public:
+
+		ArchetypeManager() = default;
+		~ArchetypeManager() = default;
+
+		template<typename T>
+		void RegisterComponent()
+		{
+			static_assert(!IsTagComponent<T>, "Tag components have no storage.");
+
+			const ComponentType type = ecs::GetComponentTypeID<T>();
+
+			assert(!m_Registered.test(type) && "Component already registered, or its ID is used by another type!");
+
+			m_ComponentInfos[type] = MakeComponentInfo<T>();
+			m_Registered.set(type);
+		}
+
+		template<typename T>
+		void AddComponent(Entity entity, const T& component)
+		{
+			const ComponentType type = ecs::GetComponentTypeID<T>();
+
+			assert(m_Registered.test(type) && "Component not registered!");
+
+			EntityRecord& record = GetRecord(entity);
+
+			assert(!(record.archetype && record.archetype->GetSignature().test(type))
+				&& "Component added to same entity more than once.");
+
+			MoveEntity(entity, record, GetAddTarget(record.archetype, type));
+
+			void* slot = record.archetype->GetComponentData(record.row, record.archetype->GetColumn(type));
+			::new (slot) T(component);
+		}
+
+		/// Batched add: every entity moves straight to its final archetype
+		/// (one move instead of one per component), and the target lookup
+		/// is reused while consecutive entities come from the same archetype.
+		template<typename... Ts>
+		void AddComponents(std::span<const Entity> entities, std::span<const Ts>... components)
+		{
+			// Tags in the batch are only signature bits, handled by the Coordinator
+			if constexpr ((IsTagComponent<Ts> && ...))
+				return;
+
+			constexpr Signature added = MakeStorageSignature<Ts...>();
+
+			assert(m_Registered.Contains(added) && "Component not registered!");
+
+			Archetype* source = nullptr;
+			Archetype* target = nullptr;
+			std::array<std::uint32_t, sizeof...(Ts)> columns{};
+
+			for (std::size_t i = 0; i < entities.size(); ++i)
+			{
+				EntityRecord& record = GetRecord(entities[i]);
+
+				assert(!(record.archetype && record.archetype->GetSignature().Intersects(added))
+					&& "Component added to same entity more than once.");
+
+				if (!target || record.archetype != source)
+				{
+					source = record.archetype;
+					target = GetOrCreateArchetype(source ? source->GetSignature() | added : added);
+					columns = { target->GetColumn(ecs::GetComponentTypeID<Ts>())... };
+				}
+
+				MoveEntity(entities[i], record, target);
+				ConstructComponents(*target, record.row, columns, std::index_sequence_for<Ts...>{}, components[i]...);
+			}
+		}
+
+		template<typename T>
+		void RemoveComponent(Entity entity)
+		{
+			const ComponentType type = ecs::GetComponentTypeID<T>();
+			EntityRecord& record = GetRecord(entity);
+
+			assert(record.archetype && record.archetype->GetSignature().test(type)
+				&& "Removing non-existent component.");
+
+			MoveEntity(entity, record, GetRemoveTarget(record.archetype, type));
+		}
+
+		/** Mutable access stamps T's column in the entity's chunk, GetComponent<const T> doesn't */
+		template<typename T>
+		T& GetComponent(Entity entity)
+		{
+			const ComponentType type = ecs::GetComponentTypeID<T>();
+			EntityRecord& record = GetRecord(entity);
+
+			assert(record.archetype && record.archetype->GetSignature().test(type)
+				&& "Retrieving non-existent component.");
+
+			const std::uint32_t column = record.archetype->GetColumn(type);
+
+			if constexpr (!std::is_const_v<T>)
+				record.archetype->SetChangeTick(record.row / record.archetype->GetChunkCapacity(), column, m_Tick);
+
+			return *static_cast<T*>(record.archetype->GetComponentData(record.row, column));
+		}
+
+		void EntityDestroyed(Entity entity);
+
+		/** Copies every component of the entity to the prefab */
+		void CopyComponents(Entity entity, Prefab& prefab);
+
+		/// Puts entities that have no component yet straight into the
+		/// prefab's archetype: their rows are contiguous, so each column
+		/// is filled with one bulk copy per chunk.
+		void Instantiate(std::span<const Entity> entities, const Prefab& prefab);
+
+		/** Sorts the set by where T is stored, so iterating it walks each chunk column forward */
+		template<typename T>
+		void SortByStorageOrder(EntitySet& entities)
+		{
+			entities.Sort([this](Entity entity) { return reinterpret_cast<std::uintptr_t>(&GetComponent<T>(entity)); }, m_LayoutVersion);
+		}
+
+		/// Bumped whenever a row moves: the last row filling a hole, or an
+		/// entity moving to another archetype. One version for every type,
+		/// see IComponentArray::GetLayoutVersion.
+		std::uint32_t GetLayoutVersion() const { return m_LayoutVersion; }
+
+		/// Calls func(entity, components&...) for every entity that has all
+		/// the requested components, walking each matching archetype chunk
+		/// by chunk over its contiguous columns.
+		template<typename... Ts, typename Func>
+		void ForEach(Func&& func);
+
+		/// ForEach restricted to the chunks where the first component was
+		/// modified after the since tick. The granularity is the chunk, so
+		/// unchanged entities sharing a chunk with a changed one are visited too.
+		template<typename... Ts, typename Func>
+		void ForEachChanged(Tick since, Func&& func);
+
+		/** Calls func(count, Ts*...) once per matching chunk, with its column arrays */
+		template<typename... Ts, typename Func>
+		void ForEachChunk(Func&& func);
+
+		/// ForEach split over the job system, one chunk per job at most: func
+		/// runs concurrently on several threads. Chunks are separate 16 KB
+		/// allocations and their change ticks are stamped before the jobs
+		/// start, so no two jobs write to the same cache line.
+		template<typename... Ts, typename Func>
+		void ParallelForEach(core::JobSystem& jobs, Func&& func);
+
+		/** ForEachChunk split over the job system, see ParallelForEach */
+		template<typename... Ts, typename Func>
+		void ParallelForEachChunk(core::JobSystem& jobs, Func&& func);
+
+		/** Tick stamped on components added, moved or accessed from now on */
+		void SetTick(Tick tick) { m_Tick = tick; }
+
+	private:
+
+		struct EntityRecord
+		{
+			Archetype* archetype = nullptr;
+			std::uint32_t row = 0;
+		};
+
+		std::array<ComponentInfo, MAX_COMPONENTS> m_ComponentInfos{};
+		Signature m_Registered{};
+
+		std::vector<std::unique_ptr<Archetype>> m_Archetypes{};
+		std::unordered_map<Signature, Archetype*> m_ArchetypeLookup{};
+
+		// Where each entity lives, indexed by entity index
+		PagedArray<EntityRecord> m_Records{};
+
+		Tick m_Tick = 0;
+		std::uint32_t m_LayoutVersion = 0;
+
+		EntityRecord& GetRecord(Entity entity);
+		Archetype* GetOrCreateArchetype(const Signature& signature);
+		Archetype* GetAddTarget(Archetype* source, ComponentType type);
+		Archetype* GetRemoveTarget(Archetype* source, ComponentType type);
+
+		/** Moves the entity's shared components to target (nullptr = no components left) */
+		void MoveEntity(Entity entity, EntityRecord& record, Archetype* target);
+
+		template<std::size_t N, std::size_t... Is, typename... Ts>
+		static void ConstructComponents(Archetype& archetype, std::uint32_t row,
+			const std::array<std::uint32_t, N>& columns, std::index_sequence<Is...>, const Ts&... components)
+		{
+			((IsTagComponent<Ts> ? void() : void(::new (archetype.GetComponentData(row, columns[Is])) Ts(components))), ...);
+		}
+
+		template<typename... Ts, typename Func, std::size_t... Is>
+		void ForEachInArchetype(Archetype& archetype, Func& func, Tick since, std::index_sequence<Is...>);
+
+		template<typename... Ts, typename Func, std::size_t... Is>
+		void ForEachChunkInArchetype(Archetype& archetype, Func& func, std::index_sequence<Is...>);
+
+		/** A non-empty chunk matched by a parallel iteration, with its columns */
+		template<typename... Ts>
+		struct ChunkColumns
+		{
+			std::size_t count = 0;
+			Entity* entities = nullptr;
+			std::tuple<Ts*...> data{};
+		};
+
+		/** Stamps and lists the matching chunks, so that the jobs only touch their own chunk */
+		template<typename... Ts>
+		std::vector<ChunkColumns<Ts...>> CollectChunks();
+
+		template<typename... Ts, std::size_t... Is>
+		void CollectChunksInArchetype(Archetype& archetype, std::vector<ChunkColumns<Ts...>>& chunks, std::index_sequence<Is...>);
+	};
+
+	/// ----------------------------------------------
+	/// ForEachChunk
+	/// ----------------------------------------------
+
+	template<typename... Ts, typename Func>
+	inline void ArchetypeManager::ForEachChunk(Func&& func)
+	{
+		static_assert((!IsTagComponent<Ts> && ...), "Tag components can't be iterated, use them in a system signature.");
+
+		constexpr Signature required = MakeSignature<Ts...>();
+
+		for (auto& archetype : m_Archetypes)
+		{
+			if (archetype->GetSignature().Contains(required))
+				ForEachChunkInArchetype<Ts...>(*archetype, func, std::index_sequence_for<Ts...>{});
+		}
+	}
+
+	/// ----------------------------------------------
+	/// ForEachChunkInArchetype
+	/// ----------------------------------------------
+
+	template<typename... Ts, typename Func, std::size_t... Is>
+	inline void ArchetypeManager::ForEachChunkInArchetype(Archetype& archetype, Func& func, std::index_sequence<Is...>)
+	{
+		const std::array<std::uint32_t, sizeof...(Ts)> columns{ archetype.GetColumn(ecs::GetComponentTypeID<Ts>())... };
+
+		for (std::size_t c = 0; c < archetype.GetChunkCount(); ++c)
+		{
+			Chunk& chunk = archetype.GetChunk(c);
+
+			if (chunk.count == 0)
+				continue;
+
+			((std::is_const_v<Ts> ? void() : archetype.SetChangeTick(c, columns[Is], m_Tick)), ...);
+
+			func(std::size_t(chunk.count), static_cast<Ts*>(archetype.GetColumnData(chunk, columns[Is]))...);
+		}
+	}
+
+	/// ----------------------------------------------
+	/// ForEach
+	/// ----------------------------------------------
+
+	template<typename... Ts, typename Func>
+	inline void ArchetypeManager::ForEach(Func&& func)
+	{
+		// Every stamp is >= 1, so since = 0 keeps every chunk
+		ForEachChanged<Ts...>(0, func);
+	}
+
+	/// ----------------------------------------------
+	/// ForEachChanged
+	/// ----------------------------------------------
+
+	template<typename... Ts, typename Func>
+	inline void ArchetypeManager::ForEachChanged(Tick since, Func&& func)
+	{
+		static_assert((!IsTagComponent<Ts> && ...), "Tag components can't be iterated, use them in a system signature.");
+
+		constexpr Signature required = MakeSignature<Ts...>();
+
+		for (auto& archetype : m_Archetypes)
+		{
+			if (archetype->GetSignature().Contains(required))
+				ForEachInArchetype<Ts...>(*archetype, func, since, std::index_sequence_for<Ts...>{});
+		}
+	}
+
+	/// ----------------------------------------------
+	/// ForEachInArchetype
+	/// ----------------------------------------------
+
+	template<typename... Ts, typename Func, std::size_t... Is>
+	inline void ArchetypeManager::ForEachInArchetype(Archetype& archetype, Func& func, Tick since, std::index_sequence<Is...>)
+	{
+		const std::array<std::uint32_t, sizeof...(Ts)> columns{ archetype.GetColumn(ecs::GetComponentTypeID<Ts>())... };
+
+		for (std::size_t c = 0; c < archetype.GetChunkCount(); ++c)
+		{
+			if (archetype.GetChangeTick(c, columns[0]) <= since)
+				continue;
+
+			// The writable columns are about to be modified
+			((std::is_const_v<Ts> ? void() : archetype.SetChangeTick(c, columns[Is], m_Tick)), ...);
+
+			Chunk& chunk = archetype.GetChunk(c);
+			Entity* entities = archetype.GetEntities(chunk);
+			std::tuple<Ts*...> data{ static_cast<Ts*>(archetype.GetColumnData(chunk, columns[Is]))... };
+
+			for (std::uint32_t i = 0; i < chunk.count; ++i)
+				func(entities[i], std::get<Is>(data)[i]...);
+		}
+	}
+
+	/// ----------------------------------------------
+	/// ParallelForEach
+	/// ----------------------------------------------
+
+	template<typename... Ts, typename Func>
+	inline void ArchetypeManager::ParallelForEach(core::JobSystem& jobs, Func&& func)
+	{
+		const auto chunks = CollectChunks<Ts...>();
+
+		jobs.ParallelFor(chunks.size(), 1, [&chunks, &func](std::size_t begin, std::size_t end) {
+			for (std::size_t c = begin; c < end; ++c)
+			{
+				const ChunkColumns<Ts...>& chunk = chunks[c];
+
+				for (std::size_t i = 0; i < chunk.count; ++i)
+					std::apply([&](Ts*... data) { func(chunk.entities[i], data[i]...); }, chunk.data);
+			}
+		});
+	}
+
+	/// ----------------------------------------------
+	/// ParallelForEachChunk
+	/// ----------------------------------------------
+
+	template<typename... Ts, typename Func>
+	inline void ArchetypeManager::ParallelForEachChunk(core::JobSystem& jobs, Func&& func)
+	{
+		const auto chunks = CollectChunks<Ts...>();
+
+		jobs.ParallelFor(chunks.size(), 1, [&chunks, &func](std::size_t begin, std::size_t end) {
+			for (std::size_t c = begin; c < end; ++c)
+				std::apply([&](Ts*... data) { func(chunks[c].count, data...); }, chunks[c].data);
+		});
+	}
+
+	/// ----------------------------------------------
+	/// CollectChunks
+	/// ----------------------------------------------
+
+	template<typename... Ts>
+	inline std::vector<ArchetypeManager::ChunkColumns<Ts...>> ArchetypeManager::CollectChunks()
+	{
+		static_assert((!IsTagComponent<Ts> && ...), "Tag components can't be iterated, use them in a system signature.");
+
+		constexpr Signature required = MakeSignature<Ts...>();
+		std::vector<ChunkColumns<Ts...>> chunks;
+
+		for (auto& archetype : m_Archetypes)
+		{
+			if (archetype->GetSignature().Contains(required))
+				CollectChunksInArchetype<Ts...>(*archetype, chunks, std::index_sequence_for<Ts...>{});
+		}
+
+		return chunks;
+	}
+
+	/// ----------------------------------------------
+	/// CollectChunksInArchetype
+	/// ----------------------------------------------
+
+	template<typename... Ts, std::size_t... Is>
+	inline void ArchetypeManager::CollectChunksInArchetype(Archetype& archetype, std::vector<ChunkColumns<Ts...>>& chunks, std::index_sequence<Is...>)
+	{
+		const std::array<std::uint32_t, sizeof...(Ts)> columns{ archetype.GetColumn(ecs::GetComponentTypeID<Ts>())... };
+
+		for (std::size_t c = 0; c < archetype.GetChunkCount(); ++c)
+		{
+			Chunk& chunk = archetype.GetChunk(c);
+
+			if (chunk.count == 0)
+				continue;
+
+			((std::is_const_v<Ts> ? void() : archetype.SetChangeTick(c, columns[Is], m_Tick)), ...);
+
+			chunks.push_back({ std::size_t(chunk.count), archetype.GetEntities(chunk),
+				{ static_cast<Ts*>(archetype.GetColumnData(chunk, columns[Is]))... } });
+		}
+	}
+}
@@ -0,0 +1,278 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <cassert>
+#include "ecs/Entity.h"
+#include "ecs/Component.h"
+#include "ecs/Signature.h"
+#include "ecs/SparseIndex.h"
+#include "ecs/Coordinator.h"
+
+namespace ecs {
+
+	// -----------------------------------------
+	// Command Pool
+	// -----------------------------------------
+
+	/// Pending adds and removes of one component type.
+	/// Commands are coalesced per entity while they are recorded: a second
+	/// add overwrites the first one, and a remove cancels a pending add.
+	/// Removes are applied before adds, so "remove then add" is a replace.
+
+	class ICommandPool
+	{
+	public:
+		virtual ~ICommandPool() = default;
+		virtual void Apply(Coordinator& coordinator) = 0;
+		virtual void Clear() = 0;
+	};
+
+	template<typename T>
+	class CommandPool : public ICommandPool
+	{
+	public:
+
+		void Add(Entity entity, T component);
+		void Remove(Entity entity);
+		void Apply(Coordinator& coordinator) override;
+		void Clear() override;
+
+	private:
+
+		SparseIndex m_AddIndex{};
+		std::vector<Entity> m_AddEntities{};
+		std::vector<T> m_AddComponents{};
+
+		SparseIndex m_RemoveIndex{};
+		std::vector<Entity> m_RemoveEntities{};
+
+		void ClearIndices();
+	};
+
+	// -----------------------------------------
+	// Command Buffer
+	// -----------------------------------------
+
+	/// Records structural changes (destroy, add, remove) so that systems can
+	/// request them while iterating their entities, and applies them later
+	/// at a sync point with Flush().
+	///
+	/// Flush() destroys entities first (commands left for them are dropped),
+	/// then goes through the component pools in type order, each one doing
+	/// its removes and its adds as a single batch. It brings the entities
+	/// reserved by jobs (Coordinator::ReserveEntity) to life before anything
+	/// else, so commands can be recorded for them right away.
+	///
+	/// A buffer is not thread safe: give each thread its own.
+
+	class CommandBuffer
+	{
+	public:
+
+		CommandBuffer() = default;
+		~CommandBuffer() = default;
+
+		CommandBuffer(const CommandBuffer&) = delete;
+		CommandBuffer& operator=(const CommandBuffer&) = delete;
+
+		void DestroyEntity(Entity entity);
+
+		template<typename T>
+		void AddComponent(Entity entity, T component)
+		{
+			GetPool<T>().Add(entity, std::move(component));
+		}
+
+		template<typename T>
+		void RemoveComponent(Entity entity)
+		{
+			GetPool<T>().Remove(entity);
+		}
+
+		bool Empty() const { return m_Destroyed.empty() && m_UsedPools.empty(); }
+
+		/** Applies every recorded command to the coordinator and clears the buffer */
+		void Flush(Coordinator& coordinator);
+
+		/** Drops every recorded command */
+		void Clear();
+
+	private:
+
+		SparseIndex m_DestroyIndex{};
+		std::vector<Entity> m_Destroyed{};
+
+		// Pools are kept across flushes to reuse their capacity
+		std::array<std::unique_ptr<ICommandPool>, MAX_COMPONENTS> m_Pools{};
+		std::vector<ComponentType> m_UsedPools{};
+		Signature m_Used{};
+
+		template<typename T>
+		CommandPool<T>& GetPool();
+	};
+
+	/// ----------------------------------------------
+	/// CommandBuffer::GetPool
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline CommandPool<T>& CommandBuffer::GetPool()
+	{
+		const ComponentType type = ecs::GetComponentTypeID<T>();
+
+		if (!m_Pools[type])
+			m_Pools[type] = std::make_unique<CommandPool<T>>();
+
+		if (!m_Used.test(type))
+		{
+			m_Used.set(type);
+			m_UsedPools.push_back(type);
+		}
+
+		return static_cast<CommandPool<T>&>(*m_Pools[type]);
+	}
+
+	/// ----------------------------------------------
+	/// CommandPool::Add
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void CommandPool<T>::Add(Entity entity, T component)
+	{
+		const auto index = m_AddIndex.Find(entity);
+
+		if (index != SparseIndex::INVALID_INDEX)
+		{
+			// Last add wins
+			m_AddEntities[index] = entity;
+			m_AddComponents[index] = std::move(component);
+			return;
+		}
+
+		m_AddIndex.Set(entity, static_cast<SparseIndex::Index>(m_AddEntities.size()));
+		m_AddEntities.push_back(entity);
+		m_AddComponents.push_back(std::move(component));
+	}
+
+	/// ----------------------------------------------
+	/// CommandPool::Remove
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void CommandPool<T>::Remove(Entity entity)
+	{
+		const auto index = m_AddIndex.Find(entity);
+
+		if (index != SparseIndex::INVALID_INDEX)
+		{
+			// Cancel the pending add, swapping the last one into its place
+			const auto last = static_cast<SparseIndex::Index>(m_AddEntities.size() - 1);
+
+			if (index != last)
+			{
+				m_AddEntities[index] = m_AddEntities[last];
+				m_AddComponents[index] = std::move(m_AddComponents[last]);
+				m_AddIndex.Set(m_AddEntities[index], index);
+			}
+
+			m_AddEntities.pop_back();
+			m_AddComponents.pop_back();
+			m_AddIndex.Erase(entity);
+		}
+
+		// The entity may still own the component from before
+		if (!m_RemoveIndex.Contains(entity))
+		{
+			m_RemoveIndex.Set(entity, static_cast<SparseIndex::Index>(m_RemoveEntities.size()));
+			m_RemoveEntities.push_back(entity);
+		}
+	}
+
+	/// ----------------------------------------------
+	/// CommandPool::Apply
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void CommandPool<T>::Apply(Coordinator& coordinator)
+	{
+		// The vectors are filtered in place below
+		ClearIndices();
+
+		// Removes: skip entities that died or never had the component
+		std::erase_if(m_RemoveEntities, [&coordinator](Entity entity)
+			{ return !coordinator.IsAlive(entity) || !coordinator.HasComponent<T>(entity); });
+
+		if (!m_RemoveEntities.empty())
+			coordinator.RemoveComponents<T>(m_RemoveEntities);
+
+		// Adds: overwrite components that already exist, batch-insert the rest
+		std::size_t kept = 0;
+
+		for (std::size_t i = 0; i < m_AddEntities.size(); ++i)
+		{
+			const Entity entity = m_AddEntities[i];
+
+			if (!coordinator.IsAlive(entity))
+				continue;
+
+			if (coordinator.HasComponent<T>(entity))
+			{
+				if constexpr (!IsTagComponent<T>)
+					coordinator.SetComponent<T>(entity, m_AddComponents[i]);
+				continue;
+			}
+
+			if (kept != i)
+			{
+				m_AddEntities[kept] = entity;
+				m_AddComponents[kept] = std::move(m_AddComponents[i]);
+			}
+			++kept;
+		}
+
+		if (kept > 0)
+		{
+			coordinator.AddComponents<T>(
+				std::span<const Entity>(m_AddEntities.data(), kept),
+				std::span<const T>(m_AddComponents.data(), kept));
+		}
+
+		m_AddEntities.clear();
+		m_AddComponents.clear();
+		m_RemoveEntities.clear();
+	}
+
+	/// ----------------------------------------------
+	/// CommandPool::Clear
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void CommandPool<T>::Clear()
+	{
+		ClearIndices();
+
+		m_AddEntities.clear();
+		m_AddComponents.clear();
+		m_RemoveEntities.clear();
+	}
+
+	/// ----------------------------------------------
+	/// CommandPool::ClearIndices
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void CommandPool<T>::ClearIndices()
+	{
+		// Only touch the slots that were used, the pages stay allocated
+		for (Entity entity : m_AddEntities)
+			m_AddIndex.Erase(entity);
+
+		for (Entity entity : m_RemoveEntities)
+			m_RemoveIndex.Erase(entity);
+	}
+}
@@ -1,11 +1,166 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 namespace ecs {
 
 	// A simple type alias
-	using ComponentType = std::uint8_t;
+	using ComponentType = std::uint16_t;
 
-	// Used to define the size of arrays later on
-	const ComponentType MAX_COMPONENTS = 32;
-}
\ No newline at end of file
+	// Used to define the size of arrays and signatures later on
+	// (must be a multiple of 128, see Signature)
+	constexpr ComponentType MAX_COMPONENTS = 256;
+
+	// Change tick: the Coordinator's clock value stamped on a component
+	// when it's added or accessed mutably (see Coordinator::AdvanceTick)
+	using Tick = std::uint32_t;
+
+	// -----------------------------------------
+	// Compile-time Component Type IDs
+	// -----------------------------------------
+
+	/// Every component type gets a fixed ID, declared once next to the type
+	/// (at global scope) with:
+	///
+	///		ECS_COMPONENT(ecs::Transform, 0)
+	///
+	/// IDs are constants: they don't depend on registration order, need no
+	/// static initialization, are the same in every module (EngineCore, App)
+	/// and in every run, so they can be written in snapshots and replays and
+	/// used to build signatures at compile time (see ecs::MakeSignature).
+	/// Using a component that was never declared is a compile error, and
+	/// an ID declared twice is caught when the second type is registered.
+
+	template<typename T>
+	struct ComponentTraits;
+
+	template<typename T>
+	constexpr ComponentType GetComponentTypeID()
+	{
+		return ComponentTraits<std::remove_cv_t<T>>::ID;
+	}
+
+	/// Called when a type is registered with an ID that is already taken.
+	/// Checked in release builds too: two types declared with the same ID
+	/// would silently share a signature bit (or a system slot).
+	[[noreturn]] inline void DuplicateTypeID(const char* kind, unsigned id)
+	{
+		std::fprintf(stderr, "ecs: %s ID %u registered twice, or declared by two types.\n", kind, id);
+		std::abort();
+	}
+
+	// -----------------------------------------
+	// Tag Components
+	// -----------------------------------------
+
+	/// Empty types (markers like Static, Visible, Selected) are tags: they
+	/// only exist as a bit in the entity signature. Adding or removing one
+	/// flips the bit and updates the systems, no storage is ever allocated.
+	/// Tags can be used in system signatures but not fetched or iterated.
+
+	template<typename T>
+	constexpr bool IsTagComponent = std::is_empty_v<std::remove_cv_t<T>>;
+
+	// -----------------------------------------
+	// Column-wise (SoA) Components
+	// -----------------------------------------
+
+	/// Components made only of floats can opt in to a column-wise layout
+	/// by declaring themselves with ECS_SOA_COMPONENT instead of ECS_COMPONENT.
+	/// The SparseSet storage then keeps one paged float array per
+	/// field (position.x[], position.y[], ...) so kernels written against
+	/// Coordinator::ForEachColumns can process several entities per SIMD
+	/// instruction. Such components are read by value and written with
+	/// SetComponent or through their columns, never by reference.
+
+	template<typename T>
+	constexpr bool IsSoAComponent = requires { requires ComponentTraits<std::remove_cv_t<T>>::SOA; };
+
+	// -----------------------------------------
+	// Bulk Construction
+	// -----------------------------------------
+
+	/// Copy-constructs count copies of value in the raw memory at dst.
+	/// Trivially copyable types are replicated with memcpy, doubling the
+	/// block copied each time, so the cost doesn't grow with the type's
+	/// constructor and N slots take log2(N) calls.
+
+	template<typename T>
+	void FillConstruct(T* dst, const T& value, std::size_t count)
+	{
+		if constexpr (std::is_trivially_copyable_v<T>)
+		{
+			if (count == 0)
+				return;
+
+			std::memcpy(dst, &value, sizeof(T));
+
+			for (std::size_t done = 1; done < count; done *= 2)
+			{
+				const std::size_t n = done < count - done ? done : count - done;
+				std::memcpy(dst + done, dst, n * sizeof(T));
+			}
+		}
+		else
+		{
+			for (std::size_t i = 0; i < count; ++i)
+				::new (static_cast<void*>(dst + i)) T(value);
+		}
+	}
+
+	// -----------------------------------------
+	// Component Info
+	// -----------------------------------------
+
+	/// Type-erased description of a component type. The archetype storage
+	/// only knows its columns by size, and prefabs hold their components
+	/// by type ID, so copying, moving and destroying values goes through
+	/// these function pointers.
+
+	struct ComponentInfo
+	{
+		std::size_t size = 0;
+		std::size_t alignment = 1;
+		void (*moveConstruct)(void* dst, void* src) = nullptr;
+		void (*fillConstruct)(void* dst, const void* src, std::size_t count) = nullptr;
+		void (*destroy)(void* ptr) = nullptr;
+	};
+
+	template<typename T>
+	ComponentInfo MakeComponentInfo()
+	{
+		ComponentInfo info;
+		info.size = sizeof(T);
+		info.alignment = alignof(T);
+		info.moveConstruct = [](void* dst, void* src) { ::new (dst) T(std::move(*static_cast<T*>(src))); };
+		info.fillConstruct = [](void* dst, const void* src, std::size_t count) { FillConstruct(static_cast<T*>(dst), *static_cast<const T*>(src), count); };
+		info.destroy = [](void* ptr) { static_cast<T*>(ptr)->~T(); };
+		return info;
+	}
+}
+
+#define ECS_COMPONENT(Type, Id) \
+	template<> \
+	struct ecs::ComponentTraits<Type> \
+	{ \
+		static constexpr ecs::ComponentType ID = Id; \
+		static_assert(ID < ecs::MAX_COMPONENTS, "Component ID out of range."); \
+	};
+
+#define ECS_SOA_COMPONENT(Type, Id) \
+	template<> \
+	struct ecs::ComponentTraits<Type> \
+	{ \
+		static constexpr ecs::ComponentType ID = Id; \
+		static constexpr bool SOA = true; \
+		static_assert(ID < ecs::MAX_COMPONENTS, "Component ID out of range."); \
+	};
+
+// Column index of a float field of a SoA component: ECS_SOA_FIELD(Transform, rotation.y)
+#define ECS_SOA_FIELD(Type, Field) (offsetof(Type, Field) / sizeof(float))
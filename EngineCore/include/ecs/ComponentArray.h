@@ -1,9 +1,16 @@
 #pragma once
 
-#include <array>
-#include <unordered_map>
+#include <vector>
+#include <span>
+#include <utility>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
 #include <cassert>
 #include "ecs/Entity.h"
+#include "ecs/Component.h"
+#include "ecs/SparseIndex.h"
+#include "ecs/PagedArray.h"
 
 namespace ecs {
 
@@ -19,36 +26,82 @@ namespace ecs {
 	public:
 		virtual ~IComponentArray() = default;
 		virtual void EntityDestroyed(Entity entity) = 0;
+
+		/// Type-erased access used by prefabs, which only know a component
+		/// by its type ID: component points to a value of the stored type.
+		/** Copy-constructs the entity's component at dst */
+		virtual void CopyData(Entity entity, void* dst) = 0;
+
+		/** Gives each entity a copy of component */
+		virtual void InsertCopies(std::span<const Entity> entities, const void* component, Tick tick) = 0;
+
+		/// Bumped whenever components already in the array change position
+		/// (swap-removes, group sorting, ArrangeComponents), not by appends.
+		/// An order derived from the packed positions, like a system list
+		/// sorted by them, holds as long as this is the version it was made at.
+		std::uint32_t GetLayoutVersion() const { return m_LayoutVersion; }
+
+	protected:
+		std::uint32_t m_LayoutVersion = 0;
 	};
 
-	/// Some performance downside using unordered_maps because they are not contiguous
-	/// But the unordered_maps have the nice property of supporting find(), 
-	/// insert(), and delete(), which allow for asserting validity without "if(valid)" 
-	/// checks and it's a bit clearer then setting array elements to some "INVALID" value.
+	/// Sparse set storage: a paged sparse index maps entity -> packed index,
+	/// and a dense vector maps packed index -> entity. Every lookup is plain
+	/// array indexing (no hashing), and the dense entity vector is kept in the
+	/// same order as the packed component array.
+	/// Each slot also carries the tick of its last modification, kept in a
+	/// parallel array so queries that skip unchanged components stay dense.
 
 	template<typename T>
 	class ComponentArray : public IComponentArray
 	{
 	public:
 
-		void InsertData(Entity entity, T component);
+		void InsertData(Entity entity, T component, Tick tick);
+		void InsertData(std::span<const Entity> entities, std::span<const T> components, Tick tick);
+		void Reserve(std::size_t capacity);
 		void RemoveData(Entity entity);
+		void RemoveData(std::span<const Entity> entities);
 		T& GetData(Entity entity);
 		void EntityDestroyed(Entity entity) override;
+		void CopyData(Entity entity, void* dst) override;
+		void InsertCopies(std::span<const Entity> entities, const void* component, Tick tick) override;
+
+		/** Position of the entity's component in the packed array */
+		SparseIndex::Index GetIndex(Entity entity) const { return m_EntityToIndex.Get(entity); }
+
+		/** Packed position of the entity's component, or SparseIndex::INVALID_INDEX */
+		SparseIndex::Index Find(Entity entity) const { return m_EntityToIndex.Find(entity); }
+		bool Contains(Entity entity) const { return m_EntityToIndex.Contains(entity); }
+
+		/** Direct access to the packed arrays, in the same order */
+		std::size_t Size() const { return m_IndexToEntity.size(); }
+		const Entity* GetEntities() const { return m_IndexToEntity.data(); }
+		T& GetDataAt(std::size_t index) { return m_Array[index]; }
+
+		/** Tick of the last modification of the component at a packed position */
+		Tick GetChangeTick(std::size_t index) const { return m_ChangeTicks[index]; }
+		void SetChangeTick(std::size_t index, Tick tick) { m_ChangeTicks[index] = tick; }
+
+		/** Swaps two packed positions, used by owning groups to co-sort arrays */
+		void SwapSlots(std::size_t a, std::size_t b);
 
 	private:
 
-		// packed array
-		std::array<T, MAX_ENTITIES> m_Array;
+		// packed array, grows one page at a time
+		PagedArray<T> m_Array{};
+
+		// Last modification tick of each packed component, same order
+		PagedArray<Tick> m_ChangeTicks{};
 
-		// Map from an entity ID to an array index.
-		std::unordered_map<Entity, size_t> m_EntityToIndexMap;
+		// Paged map from an entity ID to an array index.
+		SparseIndex m_EntityToIndex{};
 
-		// Map from an array index to an entity ID.
-		std::unordered_map<size_t, Entity> m_IndexToEntityMap;
+		// Dense map from an array index to an entity ID.
+		// Its size is the number of valid entries in the array.
+		std::vector<Entity> m_IndexToEntity{};
 
-		// Total size of valid entries in the array.
-		size_t m_Size;
+		void RemoveAt(SparseIndex::Index index);
 	};
 
 	/// ----------------------------------------------
@@ -56,16 +109,63 @@ namespace ecs {
 	/// ----------------------------------------------
 
 	template<typename T>
-	inline void ComponentArray<T>::InsertData(Entity entity, T component)
+	inline void ComponentArray<T>::InsertData(Entity entity, T component, Tick tick)
 	{
-		assert(m_EntityToIndexMap.find(entity) == m_EntityToIndexMap.end() 
+		assert(!m_EntityToIndex.Contains(entity)
 			&& "Component added to same entity more than once.");
 
-		size_t newIndex = m_Size;
-		m_EntityToIndexMap[entity] = newIndex;
-		m_IndexToEntityMap[newIndex] = entity;
-		m_Array[newIndex] = component;
-		++m_Size;
+		const auto newIndex = static_cast<SparseIndex::Index>(m_IndexToEntity.size());
+		m_EntityToIndex.Set(entity, newIndex);
+		m_IndexToEntity.push_back(entity);
+		m_Array.PushBack(std::move(component));
+		m_ChangeTicks.PushBack(tick);
+	}
+
+	/// ----------------------------------------------
+	/// InsertData (batch)
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void ComponentArray<T>::InsertData(std::span<const Entity> entities, std::span<const T> components, Tick tick)
+	{
+		assert(entities.size() == components.size() && "One component per entity expected.");
+
+		Reserve(m_IndexToEntity.size() + entities.size());
+
+		for (std::size_t i = 0; i < entities.size(); ++i)
+			InsertData(entities[i], components[i], tick);
+	}
+
+	/// ----------------------------------------------
+	/// InsertCopies
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void ComponentArray<T>::InsertCopies(std::span<const Entity> entities, const void* component, Tick tick)
+	{
+		auto newIndex = static_cast<SparseIndex::Index>(m_IndexToEntity.size());
+
+		for (Entity entity : entities)
+		{
+			assert(!m_EntityToIndex.Contains(entity) && "Component added to same entity more than once.");
+			m_EntityToIndex.Set(entity, newIndex++);
+		}
+
+		m_IndexToEntity.insert(m_IndexToEntity.end(), entities.begin(), entities.end());
+		m_Array.AppendCopies(entities.size(), *static_cast<const T*>(component));
+		m_ChangeTicks.AppendCopies(entities.size(), tick);
+	}
+
+	/// ----------------------------------------------
+	/// Reserve
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void ComponentArray<T>::Reserve(std::size_t capacity)
+	{
+		m_IndexToEntity.reserve(capacity);
+		m_Array.Reserve(capacity);
+		m_ChangeTicks.Reserve(capacity);
 	}
 
 	/// ----------------------------------------------
@@ -75,23 +175,81 @@ namespace ecs {
 	template<typename T>
 	inline void ComponentArray<T>::RemoveData(Entity entity)
 	{
-		assert(m_EntityToIndexMap.find(entity) != m_EntityToIndexMap.end() 
+		assert(m_EntityToIndex.Contains(entity)
 			&& "Removing non-existent component.");
 
+		RemoveAt(m_EntityToIndex.Get(entity));
+	}
+
+	/// ----------------------------------------------
+	/// RemoveData (batch)
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void ComponentArray<T>::RemoveData(std::span<const Entity> entities)
+	{
+		std::vector<SparseIndex::Index> indices;
+		indices.reserve(entities.size());
+
+		for (Entity entity : entities)
+		{
+			assert(m_EntityToIndex.Contains(entity) && "Removing non-existent component.");
+			indices.push_back(m_EntityToIndex.Get(entity));
+		}
+
+		// Highest slots first: every slot above the current one is already
+		// gone, so the element swapped in from the back is never one that
+		// is still waiting to be removed.
+		std::sort(indices.begin(), indices.end(), std::greater<>{});
+
+		for (auto index : indices)
+			RemoveAt(index);
+	}
+
+	/// ----------------------------------------------
+	/// RemoveAt
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void ComponentArray<T>::RemoveAt(SparseIndex::Index indexOfRemovedEntity)
+	{
+		const Entity entity = m_IndexToEntity[indexOfRemovedEntity];
+
 		// Copy element at end into deleted element's place to maintain density
-		size_t indexOfRemovedEntity = m_EntityToIndexMap[entity];
-		size_t indexOfLastElement = m_Size - 1;
-		m_Array[indexOfRemovedEntity] = m_Array[indexOfLastElement];
+		const auto indexOfLastElement = static_cast<SparseIndex::Index>(m_IndexToEntity.size() - 1);
+		if (indexOfRemovedEntity != indexOfLastElement)
+		{
+			m_Array[indexOfRemovedEntity] = std::move(m_Array[indexOfLastElement]);
+			m_ChangeTicks[indexOfRemovedEntity] = m_ChangeTicks[indexOfLastElement];
+			++m_LayoutVersion;
+		}
+		m_Array.PopBack();
+		m_ChangeTicks.PopBack();
+
+		// Update maps to point to moved spot
+		Entity entityOfLastElement = m_IndexToEntity[indexOfLastElement];
+		m_EntityToIndex.Set(entityOfLastElement, indexOfRemovedEntity);
+		m_IndexToEntity[indexOfRemovedEntity] = entityOfLastElement;
 
-		// Update map to point to moved spot
-		Entity entityOfLastElement = m_IndexToEntityMap[indexOfLastElement];
-		m_EntityToIndexMap[entityOfLastElement] = indexOfRemovedEntity;
-		m_IndexToEntityMap[indexOfRemovedEntity] = entityOfLastElement;
+		m_EntityToIndex.Erase(entity);
+		m_IndexToEntity.pop_back();
+	}
+
+	/// ----------------------------------------------
+	/// SwapSlots
+	/// ----------------------------------------------
 
-		m_EntityToIndexMap.erase(entity);
-		m_IndexToEntityMap.erase(indexOfLastElement);
+	template<typename T>
+	inline void ComponentArray<T>::SwapSlots(std::size_t a, std::size_t b)
+	{
+		using std::swap;
+		swap(m_Array[a], m_Array[b]);
+		swap(m_ChangeTicks[a], m_ChangeTicks[b]);
+		swap(m_IndexToEntity[a], m_IndexToEntity[b]);
 
-		--m_Size;
+		m_EntityToIndex.Set(m_IndexToEntity[a], static_cast<SparseIndex::Index>(a));
+		m_EntityToIndex.Set(m_IndexToEntity[b], static_cast<SparseIndex::Index>(b));
+		++m_LayoutVersion;
 	}
 
 	/// ----------------------------------------------
@@ -101,12 +259,21 @@ namespace ecs {
 	template<typename T>
 	inline T& ComponentArray<T>::GetData(Entity entity)
 	{
-		// TODO: insert return statement here
-		assert(m_EntityToIndexMap.find(entity) != m_EntityToIndexMap.end() 
+		assert(m_EntityToIndex.Contains(entity)
 			&& "Retrieving non-existent component.");
 
 		// Return a reference to the entity's component
-		return m_Array[m_EntityToIndexMap[entity]];
+		return m_Array[m_EntityToIndex.Get(entity)];
+	}
+
+	/// ----------------------------------------------
+	/// CopyData
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void ComponentArray<T>::CopyData(Entity entity, void* dst)
+	{
+		::new (dst) T(GetData(entity));
 	}
 
 	/// ----------------------------------------------
@@ -116,7 +283,7 @@ namespace ecs {
 	template<typename T>
 	inline void ComponentArray<T>::EntityDestroyed(Entity entity)
 	{
-		if (m_EntityToIndexMap.find(entity) != m_EntityToIndexMap.end())
+		if (m_EntityToIndex.Contains(entity))
 		{
 			// Remove the entity's component if it existed
 			RemoveData(entity);
@@ -1,40 +1,36 @@
 #pragma once
 
+#include <array>
+#include <vector>
 #include <memory>
+#include <span>
+#include <tuple>
+#include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
 #include "ecs/Component.h"
 #include "ecs/ComponentArray.h"
+#include "ecs/SoAComponentArray.h"
+#include "ecs/Group.h"
+#include "ecs/EntitySet.h"
+#include "ecs/Prefab.h"
+#include "ecs/Parallel.h"
 
 namespace ecs {
 
-	// -----------------------------------------
-	// Compile-time Component Type IDs
-	// -----------------------------------------
-
-	// limited to std::uint8_t
-	// enough for a demo
-
-	inline ComponentType GetNextComponentTypeID()
-	{
-		static ComponentType lastID = 0;
-		return lastID++;
-	}
-
-	// compile-time association type+ID
-
-	template<typename T>
-	ComponentType GetComponentTypeID()
-	{
-		static ComponentType typeID = GetNextComponentTypeID();
-		return typeID;
-	}
-
-	// In general a better solution will be using a 
-	// Reflection system 
-
 	// -----------------------------------------
 	// Component Manager
 	// -----------------------------------------
 
+	/// Pools live in a flat array indexed by ComponentType. Next to the
+	/// owning pointer each slot caches the already-cast ComponentArray<T>*,
+	/// so GetArray<T>() is a single load: no hashing, no branch and no
+	/// shared_ptr refcount traffic on the component access path.
+	/// ECS_SOA_COMPONENT types get a SoAComponentArray instead (see ComponentStorage).
+	/// Arrays owned by a group (see OwningGroup) are kept co-sorted here,
+	/// on every add and remove of one of their components.
+
 	class ComponentManager {
 
 	public:
@@ -44,29 +40,120 @@ namespace ecs {
 		{
 			const ComponentType type = ecs::GetComponentTypeID<T>();
 			
-			assert(m_ComponentArrays.find(type) == m_ComponentArrays.end() 
-				&& "Component already registered!");
+			assert(!m_ComponentArrays[type] && "Component already registered, or its ID is used by another type!");
 
-			// m_ComponentArrays[type] = std::make_shared<ComponentArray<T>>();
-			m_ComponentArrays.insert({ type, std::make_shared<ComponentArray<T>>() });
+			auto array = std::make_unique<ComponentStorage<T>>();
+			m_ComponentInfos[type] = MakeComponentInfo<T>();
+			m_TypedArrays[type] = array.get();
+			m_RegisteredArrays.push_back(array.get());
+			m_ComponentArrays[type] = std::move(array);
 		}
 
+		/// Makes Ts an owning group (see OwningGroup). Each array can be owned
+		/// by one group only; the components already there are sorted in now.
+		template<typename... Ts>
+		void RegisterGroup()
+		{
+			assert(((!m_GroupOfType[GetComponentTypeID<Ts>()]) && ...) && "Component already owned by another group!");
+
+			auto group = std::make_unique<OwningGroup<Ts...>>(GetArray<Ts>()...);
+			((m_GroupOfType[GetComponentTypeID<Ts>()] = group.get()), ...);
+			m_Groups.push_back(std::move(group));
+		}
+
+		/** Size of the group owning exactly Ts (in any order), NO_GROUP if there is none */
+		template<typename T, typename... Ts>
+		std::size_t GetGroupSize() const
+		{
+			constexpr Signature signature = MakeSignature<T, Ts...>();
+			const IGroup* group = m_GroupOfType[GetComponentTypeID<T>()];
+
+			return group && group->GetSignature() == signature ? group->Size() : NO_GROUP;
+		}
+
+		static constexpr std::size_t NO_GROUP = SIZE_MAX;
+
 		template<typename T>
 		void AddComponent(Entity entity, const T& component)
 		{
-			GetArray<T>()->InsertData(entity, component);
+			GetArray<T>()->InsertData(entity, component, m_Tick);
+
+			if (IGroup* group = GetGroup<T>())
+				group->ComponentsAdded({ &entity, 1 });
+		}
+
+		template<typename T>
+		void AddComponents(std::span<const Entity> entities, std::span<const T> components)
+		{
+			GetArray<T>()->InsertData(entities, components, m_Tick);
+
+			if (IGroup* group = GetGroup<T>())
+				group->ComponentsAdded(entities);
 		}
 
 		template<typename T>
 		void RemoveComponent(Entity entity)
 		{
+			if (IGroup* group = GetGroup<T>())
+				group->ComponentsRemoving({ &entity, 1 });
+
 			GetArray<T>()->RemoveData(entity);
 		}
 
+		template<typename T>
+		void RemoveComponents(std::span<const Entity> entities)
+		{
+			if (IGroup* group = GetGroup<T>())
+				group->ComponentsRemoving(entities);
+
+			GetArray<T>()->RemoveData(entities);
+		}
+
+		/** Mutable access stamps the component as changed, GetComponent<const T> doesn't */
 		template<typename T>
 		T& GetComponent(Entity entity)
 		{
-			return GetArray<T>()->GetData(entity);
+			static_assert(!IsSoAComponent<T>, "SoA components have no address, use ReadComponent/SetComponent.");
+
+			auto* array = GetArray<std::remove_const_t<T>>();
+
+			assert(array->Contains(entity) && "Retrieving non-existent component.");
+
+			const auto index = array->GetIndex(entity);
+
+			if constexpr (!std::is_const_v<T>)
+				array->SetChangeTick(index, m_Tick);
+
+			return array->GetDataAt(index);
+		}
+
+		/** Copy of the component, works for every layout */
+		template<typename T>
+		T ReadComponent(Entity entity)
+		{
+			auto* array = GetArray<T>();
+
+			assert(array->Contains(entity) && "Retrieving non-existent component.");
+
+			return array->GetDataAt(array->GetIndex(entity));
+		}
+
+		/** Overwrites the component and stamps it as changed, works for every layout */
+		template<typename T>
+		void SetComponent(Entity entity, const T& component)
+		{
+			auto* array = GetArray<T>();
+
+			assert(array->Contains(entity) && "Setting non-existent component.");
+
+			const auto index = array->GetIndex(entity);
+
+			if constexpr (IsSoAComponent<T>)
+				array->SetDataAt(index, component);
+			else
+				array->GetDataAt(index) = component;
+
+			array->SetChangeTick(index, m_Tick);
 		}
 
 		template<typename T>
@@ -75,25 +162,261 @@ namespace ecs {
 			return GetComponentTypeID<T>();
 		}
 
+		/** Raw pointer to T's array, resolved once by views */
+		template<typename T>
+		ComponentStorage<T>* GetComponentArray()
+		{
+			return GetArray<T>();
+		}
+
+		/// Calls func(count, SoAColumns<Ts>...) over the entities having all
+		/// the (SoA) components. The columns are the arrays themselves, one
+		/// call per page of them, if Ts are exactly an owning group (its
+		/// prefix) or if the arrays hold the same entities in the same order. Otherwise the fields of the
+		/// matching entities are gathered in the first array's order and
+		/// scattered back after func: iterating never moves components, the
+		/// packed order belongs to RegisterGroup and ArrangeComponents.
+		template<typename... Ts, typename Func>
+		void ForEachColumns(Func&& func)
+		{
+			static_assert((IsSoAComponent<Ts> && ...), "ForEachColumns needs ECS_SOA_COMPONENT types.");
+
+			ForEachColumnsDispatch<Ts...>(func, nullptr, std::index_sequence_for<Ts...>{});
+		}
+
+		/// ForEachColumns split over the job system: func runs concurrently on
+		/// ranges of the columns that start and end on cache lines of every
+		/// field and change tick array, so no two jobs write to the same line.
+		template<typename... Ts, typename Func>
+		void ParallelForEachColumns(core::JobSystem& jobs, Func&& func)
+		{
+			static_assert((IsSoAComponent<Ts> && ...), "ParallelForEachColumns needs ECS_SOA_COMPONENT types.");
+
+			ForEachColumnsDispatch<Ts...>(func, &jobs, std::index_sequence_for<Ts...>{});
+		}
+
+		/// Moves the components of the given entities (which must all have T)
+		/// to the front of T's array, in that order.
+		template<typename T>
+		void ArrangeComponents(std::span<const Entity> order)
+		{
+			assert(!GetGroup<T>() && "The array is owned by a group, which keeps its own order.");
+
+			auto* array = GetArray<T>();
+
+			// Slots below i already hold order[0..i), so order[i] is at i or after
+			for (std::size_t i = 0; i < order.size(); ++i)
+				SwapToSlot(*array, order[i], i);
+		}
+
+		/** See IComponentArray::GetLayoutVersion */
+		template<typename T>
+		std::uint32_t GetLayoutVersion()
+		{
+			return GetArray<T>()->GetLayoutVersion();
+		}
+
+		/** Sorts the set in the packed order of T's array */
+		template<typename T>
+		void SortByPackedOrder(EntitySet& entities)
+		{
+			auto* array = GetArray<T>();
+			entities.Sort([array](Entity entity) { return array->GetIndex(entity); }, array->GetLayoutVersion());
+		}
+
+		/// Prefab support, by type ID. Copies the entity's components named
+		/// in signature to the prefab; tags have no array and are skipped.
+		void CopyComponents(Entity entity, const Signature& signature, Prefab& prefab)
+		{
+			signature.ForEachSet([&](ComponentType type) {
+				if (IComponentArray* array = m_ComponentArrays[type].get())
+					array->CopyData(entity, prefab.Emplace(type, m_ComponentInfos[type]));
+			});
+		}
+
+		/** Appends one run of copies per prefab component, for entities that have none of them */
+		void Instantiate(std::span<const Entity> entities, const Prefab& prefab)
+		{
+			for (const Prefab::Component& component : prefab.GetComponents())
+			{
+				IComponentArray* array = m_ComponentArrays[component.type].get();
+
+				assert(array && "Component not registered!");
+
+				array->InsertCopies(entities, component.data, m_Tick);
+
+				// Only the last of a group's arrays to be filled completes its set
+				if (IGroup* group = m_GroupOfType[component.type])
+					group->ComponentsAdded(entities);
+			}
+		}
+
 		void EntityDestroyed(Entity entity)
 		{
-			for (auto const& [type, array] : m_ComponentArrays)
+			// Leave the groups first, the removals below must not touch their prefixes
+			for (auto& group : m_Groups)
+				group->ComponentsRemoving({ &entity, 1 });
+
+			for (auto* array : m_RegisteredArrays)
 				array->EntityDestroyed(entity);
 		}
 
+		/** Tick stamped on components added or accessed from now on */
+		void SetTick(Tick tick) { m_Tick = tick; }
+
 	private:
 
-		std::unordered_map<ComponentType, std::shared_ptr<IComponentArray>> m_ComponentArrays{};
+		Tick m_Tick = 0;
+
+		// Owning storage, indexed by ComponentType
+		std::array<std::unique_ptr<IComponentArray>, MAX_COMPONENTS> m_ComponentArrays{};
+
+		// Type-erased description of each registered type, for prefabs
+		std::array<ComponentInfo, MAX_COMPONENTS> m_ComponentInfos{};
+
+		// Same pools already cast to their ComponentArray<T>*, indexed by ComponentType
+		std::array<void*, MAX_COMPONENTS> m_TypedArrays{};
+
+		// Registered pools only, for the calls that go to all of them
+		std::vector<IComponentArray*> m_RegisteredArrays{};
+
+		std::vector<std::unique_ptr<IGroup>> m_Groups{};
+
+		// Group owning each array, if any, indexed by ComponentType
+		std::array<IGroup*, MAX_COMPONENTS> m_GroupOfType{};
 
 		template<typename T>
-		std::shared_ptr<ComponentArray<T>> GetArray()
+		ComponentStorage<T>* GetArray()
 		{
-			ComponentType type = ecs::GetComponentTypeID<T>();
+			const ComponentType type = ecs::GetComponentTypeID<T>();
 			
-			assert(m_ComponentArrays.find(type) != m_ComponentArrays.end() 
-				&& "Component not registered!");
+			assert(m_TypedArrays[type] && "Component not registered!");
 			
-			return std::static_pointer_cast<ComponentArray<T>>(m_ComponentArrays[type]);
+			return static_cast<ComponentStorage<T>*>(m_TypedArrays[type]);
+		}
+
+		template<typename T>
+		IGroup* GetGroup() const
+		{
+			return m_GroupOfType[ecs::GetComponentTypeID<T>()];
+		}
+
+		template<typename... Ts, typename Func, std::size_t... Is>
+		void ForEachColumnsDispatch(Func& func, core::JobSystem* jobs, std::index_sequence<Is...>)
+		{
+			std::tuple<ComponentStorage<std::remove_const_t<Ts>>*...> arrays{ GetArray<std::remove_const_t<Ts>>()... };
+
+			auto* lead = std::get<0>(arrays);
+			const std::size_t size = lead->Size();
+			std::size_t count = GetGroupSize<Ts...>();
+
+			// An owning group keeps them lined up already
+			if (count == NO_GROUP)
+			{
+				const bool aligned = ((std::get<Is>(arrays)->Size() == size
+					&& std::equal(lead->GetEntities(), lead->GetEntities() + size, std::get<Is>(arrays)->GetEntities())) && ...);
+
+				if (!aligned)
+				{
+					ForEachGatheredColumns<Ts...>(func, jobs, arrays, std::index_sequence<Is...>{});
+					return;
+				}
+
+				count = size;
+			}
+
+			if (count == 0)
+				return;
+
+			// Every array is paged the same way: one call per page of the range
+			const auto runColumns = [&](std::size_t begin, std::size_t end) {
+				for (std::size_t offset = begin; offset < end; )
+				{
+					const std::size_t run = std::min(end, (offset / SOA_PAGE_SIZE + 1) * SOA_PAGE_SIZE) - offset;
+
+					(StampColumns<Ts>(*std::get<Is>(arrays), offset, run), ...);
+					func(run, Columns<Ts>(*std::get<Is>(arrays), offset, run)...);
+					offset += run;
+				}
+			};
+
+			if (!jobs)
+			{
+				runColumns(0, count);
+				return;
+			}
+
+			// Fields are floats and the column pages start on a line (see SoAComponentArray)
+			ParallelForAligned(*jobs, count, ElementsPerCacheLine<float, Tick>(), runColumns);
+		}
+
+		/// ForEachColumns over arrays in different orders: the fields of the
+		/// matching entities are copied to scratch columns in the lead's order,
+		/// and written back once func is done with all of them.
+		template<typename... Ts, typename Func, typename Arrays, std::size_t... Is>
+		void ForEachGatheredColumns(Func& func, core::JobSystem* jobs, Arrays& arrays, std::index_sequence<Is...>)
+		{
+			auto* lead = std::get<0>(arrays);
+
+			// Packed position of every matching entity in each array
+			std::array<std::vector<SparseIndex::Index>, sizeof...(Ts)> indices;
+
+			for (std::size_t i = 0; i < lead->Size(); ++i)
+			{
+				const Entity entity = lead->GetEntities()[i];
+
+				if ((std::get<Is>(arrays)->Contains(entity) && ...))
+					(indices[Is].push_back(std::get<Is>(arrays)->GetIndex(entity)), ...);
+			}
+
+			const std::size_t count = indices[0].size();
+
+			if (count == 0)
+				return;
+
+			std::tuple<SoAScratch<Ts>...> scratch;
+			(std::get<Is>(scratch).Gather(*std::get<Is>(arrays), indices[Is]), ...);
+			(StampGathered<Ts>(*std::get<Is>(arrays), indices[Is]), ...);
+
+			if (!jobs)
+			{
+				func(count, std::get<Is>(scratch).Columns()...);
+			}
+			else
+			{
+				// The jobs only write the scratch columns, which start on a line
+				ParallelForAligned(*jobs, count, ElementsPerCacheLine<float>(), [&](std::size_t begin, std::size_t end) {
+					func(end - begin, std::get<Is>(scratch).Columns(begin, end - begin)...);
+				});
+			}
+
+			(std::get<Is>(scratch).Scatter(*std::get<Is>(arrays), indices[Is]), ...);
+		}
+
+		template<typename T, typename Array>
+		void StampGathered(Array& array, std::span<const SparseIndex::Index> indices)
+		{
+			if constexpr (!std::is_const_v<T>)
+			{
+				for (SparseIndex::Index index : indices)
+					array.SetChangeTick(index, m_Tick);
+			}
+		}
+
+		template<typename T, typename Array>
+		static SoAColumns<T> Columns(Array& array, std::size_t offset, std::size_t count)
+		{
+			if constexpr (std::is_const_v<T>)
+				return std::as_const(array).GetColumns(offset, count);
+			else
+				return array.GetColumns(offset, count);
+		}
+
+		template<typename T, typename Array>
+		void StampColumns(Array& array, std::size_t offset, std::size_t count)
+		{
+			if constexpr (!std::is_const_v<T>)
+				array.SetChangeTicks(offset, count, m_Tick);
 		}
 	};
 }
@@ -1,67 +1,578 @@
 #pragma once
 #include <memory>
+#include <span>
+#include <vector>
+#include <tuple>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
 #include "EntityManager.h"
 #include "ComponentManager.h"
+#include "ArchetypeManager.h"
 #include "SystemManager.h"
+#include "ObserverManager.h"
+#include "Prefab.h"
+#include "View.h"
+#include "Parallel.h"
 
 namespace ecs {
 
+	/// Where component data is stored:
+	/// SparseSet - one packed ComponentArray per component type
+	/// Archetype - entities with the same signature share 16 KB chunks, one column per component
+	enum class StorageBackend { SparseSet, Archetype };
+
 	class Coordinator {
 
 	public:
 
-		void Init()
+		void Init(StorageBackend backend = StorageBackend::SparseSet)
 		{
-			m_ComponentManager = std::make_unique<ComponentManager>();
+			m_Backend = backend;
+
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager = std::make_unique<ArchetypeManager>();
+			else
+				m_ComponentManager = std::make_unique<ComponentManager>();
+
 			m_EntityManager = std::make_unique<EntityManager>();
 			m_SystemManager = std::make_unique<SystemManager>();
+			m_ObserverManager = std::make_unique<ObserverManager>();
+			m_RegisteredComponents = {};
+
+			SetStorageTick();
+		}
+
+		StorageBackend GetStorageBackend() const { return m_Backend; }
+
+		// CHANGE TRACKING
+
+		/// Components are stamped with the current tick when added or accessed
+		/// mutably (GetComponent<T>, non-const View/ForEach components).
+		/// A system reading changes keeps the tick of its last run:
+		///
+		///		coordinator.ForEachChanged<const Transform, WorldMatrix>(m_LastRunTick, func);
+		///		m_LastRunTick = coordinator.GetTick();
+		///
+		/// so everything written once the tick has moved on, by anyone,
+		/// compares newer. The tick only moves at sync points, never while
+		/// systems run: Scheduler::Run advances it before each phase, code
+		/// that runs systems by hand calls AdvanceTick() between them.
+		Tick GetTick() const { return m_Tick; }
+
+		/** Closes the current tick and returns it, later changes get a newer one */
+		Tick AdvanceTick()
+		{
+			// The systems of a phase stamp the tick concurrently
+			assert(!m_PhaseRunning && "AdvanceTick() inside a Scheduler phase: record GetTick(), the Scheduler advances the tick.");
+
+			const Tick closed = m_Tick++;
+			SetStorageTick();
+			return closed;
 		}
 
+		/** Set by the Scheduler while the systems of a phase run, see AdvanceTick */
+		void SetPhaseRunning(bool running) { m_PhaseRunning = running; }
+
 		// ENTITY MANAGEMENT
 		Entity CreateEntity() { return m_EntityManager->CreateEntity(); }
+
+		/** Creates count entities at once */
+		std::vector<Entity> CreateEntities(std::size_t count)
+		{
+			std::vector<Entity> entities(count);
+			m_EntityManager->CreateEntities(entities);
+			return entities;
+		}
+
+		/** O(1) check that a (possibly cached) handle still refers to a living entity */
+		bool IsAlive(Entity entity) const { return m_EntityManager->IsAlive(entity); }
+
+		/// Thread safe, for jobs that spawn entities: the ID is usable right
+		/// away to record commands, but the entity only comes alive at the
+		/// next sync point (FlushReservedEntities(), also done by
+		/// CommandBuffer::Flush and the Scheduler). Until then nothing but
+		/// other reservations may run.
+		Entity ReserveEntity() { return m_EntityManager->ReserveEntity(); }
+
+		/** Thread safe: reserves out.size() IDs at once, for jobs spawning many */
+		void ReserveEntities(std::span<Entity> out) { m_EntityManager->ReserveEntities(out); }
+
+		/** Sync point: the reserved IDs become living entities without components */
+		void FlushReservedEntities() { m_EntityManager->FlushReserved(); }
+
 		void DestroyEntity(Entity entity)
 		{
+			if (m_EntityManager->HasReserved())
+				m_EntityManager->FlushReserved();
+
+			m_ObserverManager->EntityDestroyed(entity, m_EntityManager->GetSignature(entity));
 			m_EntityManager->DestroyEntity(entity);
-			m_ComponentManager->EntityDestroyed(entity);
+
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->EntityDestroyed(entity);
+			else
+				m_ComponentManager->EntityDestroyed(entity);
+
 			m_SystemManager->EntityDestroyed(entity);
 		}
 
 		// COMPONENT MANAGEMENT
+		/// Every component type is registered once, tags included: that claims
+		/// its ID, and a second type declared with the same ID aborts right
+		/// there (release builds too). Tags (empty types) have no storage,
+		/// for them that's all registering does.
 		template<typename T>
-		void RegisterComponent() { m_ComponentManager->RegisterComponent<T>(); }
+		void RegisterComponent()
+		{
+			if (m_RegisteredComponents.test(GetComponentType<T>()))
+				DuplicateTypeID("Component", GetComponentType<T>());
+
+			m_RegisteredComponents.set(GetComponentType<T>());
+
+			if constexpr (IsTagComponent<T>)
+				return;
+			else if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->RegisterComponent<T>();
+			else
+				m_ComponentManager->RegisterComponent<T>();
+		}
+
+		/// Owning group over Ts, for sets that are often queried together:
+		/// with the SparseSet backend their arrays are kept co-sorted with the
+		/// common entities first, and View/ForEach over exactly Ts (in any
+		/// order) become a lockstep walk. An array can belong to one group
+		/// only. The Archetype backend already stores them side by side in
+		/// chunks, there it's a no-op.
+		///
+		///		coordinator.RegisterGroup<Transform, Velocity>();
+		template<typename... Ts>
+		void RegisterGroup()
+		{
+			static_assert((!IsTagComponent<Ts> && ...), "Tag components have no storage to group.");
+
+			if (m_Backend == StorageBackend::SparseSet)
+				m_ComponentManager->RegisterGroup<Ts...>();
+		}
 
 		template<typename T>
 		void AddComponent(Entity entity, const T& component)
 		{
-			m_ComponentManager->AddComponent<T>(entity, component);
+			assert(IsAlive(entity) && "Adding component to dead or stale entity.");
+			assert(m_RegisteredComponents.test(GetComponentType<T>()) && "Component not registered!");
+
+			if constexpr (!IsTagComponent<T>)
+			{
+				if (m_Backend == StorageBackend::Archetype)
+					m_ArchetypeManager->AddComponent<T>(entity, component);
+				else
+					m_ComponentManager->AddComponent<T>(entity, component);
+			}
+
 			auto signature = m_EntityManager->GetSignature(entity);
-			signature.set(m_ComponentManager->GetComponentType<T>(), true);
+			signature.set(GetComponentType<T>(), true);
 			m_EntityManager->SetSignature(entity, signature);
-			m_SystemManager->EntitySignatureChanged(entity, signature);
+			m_SystemManager->EntityComponentAdded(entity, signature, GetComponentType<T>());
+
+			if (m_ObserverManager->IsObserved(GetComponentType<T>()))
+				m_ObserverManager->ComponentAdded(GetComponentType<T>(), entity);
+		}
+
+		/// Batched AddComponent: components[i] goes to entities[i].
+		/// Storage is reserved once per component type, every signature is
+		/// written once with all the new bits, and system membership is
+		/// updated in a single pass over the batch.
+		///
+		///		coordinator.AddComponents<Transform, Velocity>(entities, transforms, velocities);
+		template<typename... Ts>
+		void AddComponents(std::span<const Entity> entities, std::span<const Ts>... components)
+		{
+			assert(((components.size() == entities.size()) && ...) && "One component per entity expected.");
+			assert(((m_RegisteredComponents.test(GetComponentType<Ts>())) && ...) && "Component not registered!");
+
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->AddComponents<Ts...>(entities, components...);
+			else
+				(AddToComponentManager<Ts>(entities, components), ...);
+
+			constexpr Signature added = MakeSignature<Ts...>();
+
+			for (Entity entity : entities)
+			{
+				assert(IsAlive(entity) && "Adding component to dead or stale entity.");
+				m_EntityManager->SetSignature(entity, m_EntityManager->GetSignature(entity) | added);
+			}
+
+			m_SystemManager->EntitiesComponentsAdded(entities, added,
+				[this](Entity entity) -> const Signature& { return m_EntityManager->GetSignature(entity); });
+
+			(NotifyComponentsAdded(GetComponentType<Ts>(), entities), ...);
 		}
 
 		template<typename T>
 		void RemoveComponent(Entity entity)
 		{
-			m_ComponentManager->RemoveComponent<T>(entity);
+			assert(IsAlive(entity) && "Removing component from dead or stale entity.");
+
+			if constexpr (!IsTagComponent<T>)
+			{
+				if (m_Backend == StorageBackend::Archetype)
+					m_ArchetypeManager->RemoveComponent<T>(entity);
+				else
+					m_ComponentManager->RemoveComponent<T>(entity);
+			}
+
 			auto signature = m_EntityManager->GetSignature(entity);
-			signature.set(m_ComponentManager->GetComponentType<T>(), false);
+			signature.set(GetComponentType<T>(), false);
 			m_EntityManager->SetSignature(entity, signature);
-			m_SystemManager->EntitySignatureChanged(entity, signature);
+			m_SystemManager->EntityComponentRemoved(entity, GetComponentType<T>());
+
+			if (m_ObserverManager->IsObserved(GetComponentType<T>()))
+				m_ObserverManager->ComponentRemoved(GetComponentType<T>(), entity);
+		}
+
+		/// Batched RemoveComponent. With the SparseSet backend the array
+		/// is compacted in one pass ordered by packed slot.
+		template<typename T>
+		void RemoveComponents(std::span<const Entity> entities)
+		{
+			const ComponentType type = GetComponentType<T>();
+
+			if constexpr (IsTagComponent<T>)
+			{
+				// Nothing stored, only the bits below change
+			}
+			else if (m_Backend == StorageBackend::Archetype)
+			{
+				for (Entity entity : entities)
+					m_ArchetypeManager->RemoveComponent<T>(entity);
+			}
+			else
+			{
+				m_ComponentManager->RemoveComponents<T>(entities);
+			}
+
+			for (Entity entity : entities)
+			{
+				assert(IsAlive(entity) && "Removing component from dead or stale entity.");
+
+				auto signature = m_EntityManager->GetSignature(entity);
+				signature.reset(type);
+				m_EntityManager->SetSignature(entity, signature);
+				m_SystemManager->EntityComponentRemoved(entity, type);
+			}
+
+			if (m_ObserverManager->IsObserved(type))
+			{
+				for (Entity entity : entities)
+					m_ObserverManager->ComponentRemoved(type, entity);
+			}
+		}
+
+		template<typename T>
+		bool HasComponent(Entity entity) const
+		{
+			return m_EntityManager->GetSignature(entity).test(ecs::GetComponentTypeID<T>());
 		}
 
+		/// Mutable access marks the component as changed at the current tick,
+		/// use GetComponent<const T> to only read it.
 		template<typename T>
 		T& GetComponent(Entity entity)
 		{
+			static_assert(!IsTagComponent<T>, "Tag components have no data, use HasComponent.");
+			static_assert(!IsSoAComponent<T>, "SoA components have no address, use ReadComponent/SetComponent.");
+
+			assert(IsAlive(entity) && "Retrieving component of dead or stale entity.");
+
+			if (m_Backend == StorageBackend::Archetype)
+				return m_ArchetypeManager->GetComponent<T>(entity);
+
 			return m_ComponentManager->GetComponent<T>(entity);
 		}
 
+		/** Copy of the component, for every layout (SoA included) */
+		template<typename T>
+		T ReadComponent(Entity entity)
+		{
+			assert(IsAlive(entity) && "Retrieving component of dead or stale entity.");
+
+			if (m_Backend == StorageBackend::Archetype)
+				return m_ArchetypeManager->GetComponent<const T>(entity);
+
+			return m_ComponentManager->ReadComponent<T>(entity);
+		}
+
+		/** Overwrites the component and marks it changed, for every layout (SoA included) */
+		template<typename T>
+		void SetComponent(Entity entity, const T& component)
+		{
+			assert(IsAlive(entity) && "Setting component of dead or stale entity.");
+
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->GetComponent<T>(entity) = component;
+			else
+				m_ComponentManager->SetComponent<T>(entity, component);
+
+			if (m_ObserverManager->IsObserved(GetComponentType<T>()))
+				m_ObserverManager->ComponentSet(GetComponentType<T>(), entity);
+		}
+
+		template<typename T>
+		static constexpr ComponentType GetComponentType()
+		{
+			return ecs::GetComponentTypeID<T>();
+		}
+
+		/// Query over the SparseSet storage yielding (Entity, Ts&...), driven by
+		/// the smallest of the component arrays (see ecs::View).
+		template<typename... Ts>
+		ecs::View<Ts...> View()
+		{
+			assert(m_Backend == StorageBackend::SparseSet && "View requires the SparseSet storage backend.");
+
+			const std::size_t groupSize = m_ComponentManager->GetGroupSize<Ts...>();
+
+			if (groupSize != ComponentManager::NO_GROUP)
+				return ecs::View<Ts...>(m_Tick, groupSize, m_ComponentManager->GetComponentArray<std::remove_const_t<Ts>>()...);
+
+			return ecs::View<Ts...>(m_Tick, m_ComponentManager->GetComponentArray<std::remove_const_t<Ts>>()...);
+		}
+
+		/// Calls func(entity, components&...) for every entity having all of Ts.
+		/// With the Archetype backend this streams through chunk columns,
+		/// with the SparseSet backend it runs a View.
+		template<typename T, typename... Ts, typename Func>
+		void ForEach(Func&& func)
+		{
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->ForEach<T, Ts...>(func);
+			else
+				View<T, Ts...>().Each(func);
+		}
+
+		/// Column kernel over SoA components: func(count, SoAColumns<Ts>...)
+		/// gets one float array per field, so its loops can be vectorized.
+		/// With the Archetype backend, which keeps components packed by value,
+		/// each chunk is transposed into scratch columns and back.
+		///
+		///		coordinator.ForEachColumns<Transform, const Velocity>([](std::size_t count, auto transform, auto velocity) { ... });
+		template<typename... Ts, typename Func>
+		void ForEachColumns(Func&& func)
+		{
+			static_assert((IsSoAComponent<Ts> && ...), "ForEachColumns needs ECS_SOA_COMPONENT types.");
+
+			if (m_Backend == StorageBackend::Archetype)
+			{
+				std::tuple<SoAScratch<Ts>...> scratch;
+
+				m_ArchetypeManager->ForEachChunk<Ts...>([&func, &scratch](std::size_t count, Ts*... data) {
+					RunColumnsOnChunk(func, scratch, count, std::index_sequence_for<Ts...>{}, data...);
+				});
+			}
+			else
+			{
+				m_ComponentManager->ForEachColumns<Ts...>(func);
+			}
+		}
+
+		// PARALLEL ITERATION
+
+		/// ForEach split over the job system, for per-entity loops with no
+		/// dependency between entities: func runs concurrently on several
+		/// threads. The SparseSet backend cuts the View on cache lines (see
+		/// View::ParallelEach: writing more than one of the components needs
+		/// an owning group over them), the Archetype backend gives each job
+		/// whole chunks.
+		template<typename T, typename... Ts, typename Func>
+		void ParallelForEach(core::JobSystem& jobs, Func&& func)
+		{
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->ParallelForEach<T, Ts...>(jobs, func);
+			else
+				View<T, Ts...>().ParallelEach(jobs, func);
+		}
+
+		/// ForEachColumns split over the job system: func(count, SoAColumns<Ts>...)
+		/// runs concurrently on column ranges that start and end on a cache
+		/// line, or on whole chunks with the Archetype backend.
+		template<typename... Ts, typename Func>
+		void ParallelForEachColumns(core::JobSystem& jobs, Func&& func)
+		{
+			static_assert((IsSoAComponent<Ts> && ...), "ParallelForEachColumns needs ECS_SOA_COMPONENT types.");
+
+			if (m_Backend == StorageBackend::Archetype)
+			{
+				m_ArchetypeManager->ParallelForEachChunk<Ts...>(jobs, [&func](std::size_t count, Ts*... data) {
+					// One scratch per thread, reused from chunk to chunk
+					thread_local std::tuple<SoAScratch<Ts>...> scratch;
+					RunColumnsOnChunk(func, scratch, count, std::index_sequence_for<Ts...>{}, data...);
+				});
+			}
+			else
+			{
+				m_ComponentManager->ParallelForEachColumns<Ts...>(jobs, func);
+			}
+		}
+
+		/// Parallel walk over a system's entity list, for systems that update
+		/// their entities one by one: func(entity, T&) runs concurrently, T
+		/// being the component the system writes (read the others with
+		/// GetComponent<const U>). The list is sorted in T's storage order and
+		/// every T is looked up (and marked changed) first, then the list is
+		/// only cut where T moves on to a new cache line, so no two jobs ever
+		/// write to the same line of T.
+		template<typename T, typename Func>
+		void ParallelForEachEntity(core::JobSystem& jobs, System& system, Func&& func)
+		{
+			static_assert(!IsTagComponent<T> && !IsSoAComponent<T>, "ParallelForEachEntity needs a component with an address.");
+
+			SortSystemEntities<T>(system);
+
+			const EntitySet& entities = system.m_Entities;
+			const std::size_t count = entities.Size();
+
+			std::vector<T*> components(count);
+			for (std::size_t i = 0; i < count; ++i)
+				components[i] = &GetComponent<T>(entities[i]);
+
+			const auto lineOf = [](const void* address) { return reinterpret_cast<std::uintptr_t>(address) / CACHE_LINE_SIZE; };
+			const std::size_t step = std::max(PARALLEL_MIN_CHUNK, count / (std::size_t(jobs.GetThreadCount()) * 4));
+
+			// Storage order, so only the entity right before a cut can share its line
+			std::vector<std::size_t> cuts{ 0 };
+			while (cuts.back() < count)
+			{
+				std::size_t cut = std::min(count, cuts.back() + step);
+
+				while (cut < count && lineOf(components[cut]) == lineOf(reinterpret_cast<const std::byte*>(components[cut - 1] + 1) - 1))
+					++cut;
+
+				cuts.push_back(cut);
+			}
+
+			jobs.ParallelFor(cuts.size() - 1, 1, [&](std::size_t begin, std::size_t end) {
+				for (std::size_t i = cuts[begin]; i < cuts[end]; ++i)
+					func(entities[i], *components[i]);
+			});
+		}
+
+		/// ForEach over the entities whose T was modified after the since tick.
+		/// Pass T as const unless the function writes it, or the visit itself
+		/// counts as a change. With the Archetype backend the filter works per
+		/// chunk, so it may also yield unchanged neighbours of changed entities.
+		template<typename T, typename... Ts, typename Func>
+		void ForEachChanged(Tick since, Func&& func)
+		{
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->ForEachChanged<T, Ts...>(since, func);
+			else
+				View<T, Ts...>().EachChanged(since, func);
+		}
+
+		// PREFABS
+
+		/// Captures the entity's whole component set (tags included) into a
+		/// prefab, to stamp out copies of it with Instantiate.
+		Prefab CreatePrefab(Entity entity)
+		{
+			assert(IsAlive(entity) && "Capturing a prefab from dead or stale entity.");
+
+			const Signature& signature = m_EntityManager->GetSignature(entity);
+			Prefab prefab;
+
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->CopyComponents(entity, prefab);
+			else
+				m_ComponentManager->CopyComponents(entity, signature, prefab);
+
+			// Tags have no storage, they only carry over as bits
+			signature.ForEachSet([&prefab](ComponentType type) {
+				if (!prefab.GetSignature().test(type))
+					prefab.SetTag(type);
+			});
+
+			return prefab;
+		}
+
+		/** Creates count entities, each with a copy of every prefab component */
+		std::vector<Entity> Instantiate(const Prefab& prefab, std::size_t count)
+		{
+			std::vector<Entity> entities = CreateEntities(count);
+			Instantiate(prefab, entities);
+			return entities;
+		}
+
+		Entity Instantiate(const Prefab& prefab)
+		{
+			const Entity entity = CreateEntity();
+			Instantiate(prefab, std::span<const Entity>(&entity, 1));
+			return entity;
+		}
+
+		/// Gives the prefab's components to entities that have none yet.
+		/// Each component type is one bulk copy into its storage, every
+		/// entity gets the prefab signature, and system membership is
+		/// updated in a single pass over the batch.
+		void Instantiate(const Prefab& prefab, std::span<const Entity> entities)
+		{
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->Instantiate(entities, prefab);
+			else
+				m_ComponentManager->Instantiate(entities, prefab);
+
+			const Signature& signature = prefab.GetSignature();
+
+			for (Entity entity : entities)
+			{
+				assert(IsAlive(entity) && "Instantiating a prefab on dead or stale entity.");
+				assert(m_EntityManager->GetSignature(entity).none() && "Instantiating a prefab on an entity that already has components.");
+
+				m_EntityManager->SetSignature(entity, signature);
+			}
+
+			// Every entity of the batch has the same signature
+			m_SystemManager->EntitiesComponentsAdded(entities, signature,
+				[&signature](Entity) -> const Signature& { return signature; });
+
+			signature.ForEachSet([this, entities](ComponentType type) { NotifyComponentsAdded(type, entities); });
+		}
+
+		// OBSERVERS
+
+		/// Batched reactions to structural changes: callback(entities) gets
+		/// every entity that gained T (OnAdd), lost it (OnRemove, destroyed
+		/// entities included) or had it overwritten with SetComponent (OnSet)
+		/// since the previous FlushObservers(), which is the sync point where
+		/// they are delivered. See ObserverManager for how events coalesce.
+		///
+		///		coordinator.OnAdd<RigidBody>([&](std::span<const Entity> entities) { physics.CreateBodies(entities); });
+		template<typename T>
+		ObserverID OnAdd(ObserverCallback callback)
+		{
+			return m_ObserverManager->Register(ObserverEvent::Add, GetComponentType<T>(), std::move(callback));
+		}
+
+		template<typename T>
+		ObserverID OnRemove(ObserverCallback callback)
+		{
+			return m_ObserverManager->Register(ObserverEvent::Remove, GetComponentType<T>(), std::move(callback));
+		}
+
 		template<typename T>
-		ComponentType GetComponentType()
+		ObserverID OnSet(ObserverCallback callback)
 		{
-			return m_ComponentManager->GetComponentType<T>();
+			return m_ObserverManager->Register(ObserverEvent::Set, GetComponentType<T>(), std::move(callback));
 		}
 
+		void RemoveObserver(ObserverID id) { m_ObserverManager->Unregister(id); }
+
+		/** Delivers the queued batches to the observers */
+		void FlushObservers() { m_ObserverManager->Flush(); }
+
 		// SYSTEM MANAGEMENT
 		template<typename T>
 		std::shared_ptr<T> RegisterSystem()
@@ -70,14 +581,99 @@ namespace ecs {
 		}
 
 		template<typename T>
-		void SetSystemSignature(std::bitset<MAX_COMPONENTS> signature)
+		void SetSystemSignature(const Signature& signature)
 		{
 			m_SystemManager->SetSignature<T>(signature);
 		}
 
+		/// The reverse of SortSystemEntities: lays out T's storage in the given
+		/// entity order (SparseSet backend), so walking the entities in that
+		/// order reads T linearly. Archetype rows are owned by their archetype,
+		/// there it's a no-op.
+		template<typename T>
+		void ArrangeComponents(std::span<const Entity> order)
+		{
+			static_assert(!IsTagComponent<T>, "Tag components have no storage order.");
+
+			if (m_Backend == StorageBackend::SparseSet)
+				m_ComponentManager->ArrangeComponents<T>(order);
+		}
+
+		/// Changes every time components of T move in the storage (see
+		/// IComponentArray::GetLayoutVersion), so an order arranged or sorted
+		/// against it can be checked. The Archetype backend has one version
+		/// for all the types.
+		template<typename T>
+		std::uint32_t GetLayoutVersion()
+		{
+			static_assert(!IsTagComponent<T>, "Tag components have no storage order.");
+
+			if (m_Backend == StorageBackend::Archetype)
+				return m_ArchetypeManager->GetLayoutVersion();
+			else
+				return m_ComponentManager->GetLayoutVersion<T>();
+		}
+
+		/// Sorts a system's entities in the storage order of component T,
+		/// so iterating m_Entities also walks T's data linearly.
+		/// Does nothing if neither the membership nor T's storage changed
+		/// since the last sort (see GetLayoutVersion).
+		template<typename T>
+		void SortSystemEntities(System& system)
+		{
+			static_assert(!IsTagComponent<T>, "Tag components have no storage order.");
+
+			if (system.m_Entities.IsSortedAt(GetLayoutVersion<T>()))
+				return;
+
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->SortByStorageOrder<T>(system.m_Entities);
+			else
+				m_ComponentManager->SortByPackedOrder<T>(system.m_Entities);
+		}
+
 	private:
+
+		template<typename Func, typename Scratch, std::size_t... Is, typename... Ts>
+		static void RunColumnsOnChunk(Func& func, Scratch& scratch, std::size_t count, std::index_sequence<Is...>, Ts*... data)
+		{
+			(std::get<Is>(scratch).Load(data, count), ...);
+			func(count, std::get<Is>(scratch).Columns()...);
+			(std::get<Is>(scratch).Store(data, count), ...);
+		}
+
+		void SetStorageTick()
+		{
+			if (m_Backend == StorageBackend::Archetype)
+				m_ArchetypeManager->SetTick(m_Tick);
+			else
+				m_ComponentManager->SetTick(m_Tick);
+		}
+
+		void NotifyComponentsAdded(ComponentType type, std::span<const Entity> entities)
+		{
+			if (!m_ObserverManager->IsObserved(type))
+				return;
+
+			for (Entity entity : entities)
+				m_ObserverManager->ComponentAdded(type, entity);
+		}
+
+		template<typename T>
+		void AddToComponentManager(std::span<const Entity> entities, std::span<const T> components)
+		{
+			if constexpr (!IsTagComponent<T>)
+				m_ComponentManager->AddComponents<T>(entities, components);
+		}
+
+		StorageBackend m_Backend = StorageBackend::SparseSet;
+		Tick m_Tick = 1;
+		bool m_PhaseRunning = false;	// see AdvanceTick
+		Signature m_RegisteredComponents{};	// every registered ID, tags included
 		std::unique_ptr<ComponentManager> m_ComponentManager;
+		std::unique_ptr<ArchetypeManager> m_ArchetypeManager;
 		std::unique_ptr<EntityManager> m_EntityManager;
 		std::unique_ptr<SystemManager> m_SystemManager;
+		std::unique_ptr<ObserverManager> m_ObserverManager;
 	};
 }
\ No newline at end of file
@@ -3,8 +3,38 @@
 
 namespace ecs {
 
+	/// An Entity is a versioned handle: the low bits are the index of the
+	/// entity slot, the high bits a generation that is bumped every time
+	/// the slot is released. A handle kept after DestroyEntity() keeps the
+	/// old generation, so it no longer matches the slot and IsAlive() fails
+	/// instead of silently aliasing the entity that reuses the index.
+	///
+	/// The split is 20 index bits (about a million entities alive at once)
+	/// and 12 generation bits: a slot can be reused 4095 times before its
+	/// generation runs out, and is then retired rather than wrapped, so an
+	/// old handle can never come back to life. More index bits would mean
+	/// slots retiring sooner under heavy churn.
+	///
+	/// The index bits are the entity cap: at most ENTITY_INDEX_MASK slots
+	/// (the last index is never handed out, see NULL_ENTITY), retired ones
+	/// included. Running out aborts, in release builds too. Below the cap
+	/// indices are handed out on demand and every per-entity storage grows
+	/// in pages as they are used.
+
 	using Entity = std::uint32_t;
 
-	const Entity MAX_ENTITIES = 5000;
-}
+	constexpr std::uint32_t ENTITY_INDEX_BITS = 20;
+	constexpr std::uint32_t ENTITY_INDEX_MASK = (1u << ENTITY_INDEX_BITS) - 1;
+	constexpr std::uint32_t ENTITY_GENERATION_MASK = UINT32_MAX >> ENTITY_INDEX_BITS;
+
+	// The last index is never handed out, so this handle is never alive
+	constexpr Entity NULL_ENTITY = UINT32_MAX;
 
+	constexpr std::uint32_t GetEntityIndex(Entity entity) { return entity & ENTITY_INDEX_MASK; }
+	constexpr std::uint32_t GetEntityGeneration(Entity entity) { return entity >> ENTITY_INDEX_BITS; }
+
+	constexpr Entity MakeEntity(std::uint32_t index, std::uint32_t generation)
+	{
+		return (index & ENTITY_INDEX_MASK) | ((generation & ENTITY_GENERATION_MASK) << ENTITY_INDEX_BITS);
+	}
+}
@@ -1,35 +1,89 @@
 #pragma once
-#include <queue>
-#include <array>
-#include <bitset>
+#include <deque>
+#include <atomic>
+#include <span>
 #include <cstdint>
 #include "ecs/Entity.h"
 #include "ecs/Component.h"
+#include "ecs/Signature.h"
+#include "ecs/PagedArray.h"
 
 namespace ecs {
 
 	/// The Entity Manager is in charge of distributing entity IDs 
 	/// and keeping record of which IDs are in use and which are not.
+	/// Released slots are recycled in FIFO order with a bumped generation,
+	/// which spreads the churn over every slot so that they retire (see
+	/// Entity.h) as late as possible.
+	///
+	/// Jobs can't create entities, but they can reserve their IDs with
+	/// ReserveEntity(): a single atomic add picks the next free handle (or a
+	/// new index past the end) without touching the storage. The reserved IDs
+	/// become living entities at the next sync point, FlushReserved(), and
+	/// are already valid to record commands for, but not IsAlive() before
+	/// it. Every other call is single threaded and may not overlap the
+	/// reservations; the ones that change the free list flush the pending
+	/// reservations first.
 
 	class EntityManager {
 
 	public:
 
-		EntityManager();
+		EntityManager() = default;
 
 		Entity CreateEntity();
+
+		/** Creates out.size() entities, growing the per-entity storage once */
+		void CreateEntities(std::span<Entity> out);
+
 		void DestroyEntity(Entity entity);
-		void SetSignature(Entity entity, std::bitset<MAX_COMPONENTS> in_Signature);
-		std::bitset<MAX_COMPONENTS> GetSignature(Entity entity) const;
+
+		/** Thread safe: an ID that stays unused by anyone else, living after FlushReserved() */
+		Entity ReserveEntity();
+
+		/** Thread safe: out.size() IDs for a single atomic add */
+		void ReserveEntities(std::span<Entity> out);
+
+		/** Makes the reserved IDs living entities, without components */
+		void FlushReserved();
+
+		bool HasReserved() const { return m_Reserved.load(std::memory_order_relaxed) != 0; }
+
+		void SetSignature(Entity entity, const Signature& in_Signature);
+		const Signature& GetSignature(Entity entity) const;
+
+		/** True if the handle refers to a living entity (stale handles fail) */
+		bool IsAlive(Entity entity) const
+		{
+			const std::uint32_t index = GetEntityIndex(entity);
+			return index < m_Handles.Size() && m_Handles[index] == entity;
+		}
+
+		std::uint32_t GetLivingEntityCount() const { return m_LivingEntityCount; }
 
 	private:
-		std::queue<Entity> m_AvailableEntities{};
+		// Handles the slots released by DestroyEntity will live as, with their
+		// bumped generation, recycled before new indices are minted.
+		// A deque rather than a queue so that reservations can index into it.
+		std::deque<Entity> m_AvailableEntities{};
+
+		// IDs reserved since the last flush: the first ones take the
+		// available handles in order, the rest the indices past the end
+		std::atomic<std::uint32_t> m_Reserved{ 0 };
+
+		// Handle of the entity living in every slot, NULL_ENTITY while the
+		// slot is free, reserved or retired: no handle ever matches those.
+		PagedArray<Entity> m_Handles{};
 
 		// tracks down which components an entity has
 		// A system would also register its interest in certain components 
 		// as another signature. Then its a simple bitwise comparison to 
 		// ensure that an entitys signature contains the systems signature.
-		std::array<std::bitset<MAX_COMPONENTS>, MAX_ENTITIES> m_Signatures{};
+		// Indexed by entity index, one slot per index ever handed out.
+		PagedArray<Signature> m_Signatures{};
 		std::uint32_t m_LivingEntityCount = 0;
+
+		/** The reservation-th ID reserved since the last flush */
+		Entity GetReservedEntity(std::uint32_t reservation) const;
 	};
 }
\ No newline at end of file
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cassert>
+#include "ecs/Entity.h"
+#include "ecs/SparseIndex.h"
+
+namespace ecs {
+
+	/// Dense set of entities (sparse set).
+	///
+	/// Insert and Erase are O(1): the sparse index gives the position in the
+	/// dense vector, and erasing swaps the last entity into the hole.
+	/// Iteration walks a contiguous std::vector<Entity>.
+	/// Swap-removal breaks any ordering, so the set remembers whether it was
+	/// modified since the last Sort() to make re-sorting cheap to skip.
+	/// When the order comes from a component storage, which can move on its
+	/// own, Sort() also records the storage's layout version (see
+	/// IComponentArray::GetLayoutVersion) and IsSortedAt() compares it.
+
+	class EntitySet
+	{
+	public:
+
+		using Iterator = std::vector<Entity>::const_iterator;
+
+		void Insert(Entity entity)
+		{
+			if (m_Sparse.Contains(entity))
+				return;
+
+			m_Sparse.Set(entity, static_cast<SparseIndex::Index>(m_Dense.size()));
+			m_Dense.push_back(entity);
+			m_Dirty = true;
+		}
+
+		void Erase(Entity entity)
+		{
+			if (!m_Sparse.Contains(entity))
+				return;
+
+			const auto index = m_Sparse.Get(entity);
+			const Entity last = m_Dense.back();
+
+			m_Dense[index] = last;
+			m_Sparse.Set(last, index);
+			m_Dense.pop_back();
+			m_Sparse.Erase(entity);
+			m_Dirty = true;
+		}
+
+		bool Contains(Entity entity) const { return m_Sparse.Contains(entity); }
+
+		std::size_t Size() const { return m_Dense.size(); }
+		bool Empty() const { return m_Dense.empty(); }
+		void Reserve(std::size_t capacity) { m_Dense.reserve(capacity); }
+
+		Entity operator[](std::size_t index) const { return m_Dense[index]; }
+		const Entity* Data() const { return m_Dense.data(); }
+
+		Iterator begin() const { return m_Dense.begin(); }
+		Iterator end() const { return m_Dense.end(); }
+
+		/** True if entities were added or removed since the last Sort() */
+		bool IsDirty() const { return m_Dirty; }
+
+		/** True if nothing was added or removed since a Sort() made at this layout version */
+		bool IsSortedAt(std::uint32_t layoutVersion) const { return !m_Dirty && m_SortedLayout == layoutVersion; }
+
+		/** Sorts the dense entities by key(entity) ascending and rebuilds the sparse side */
+		template<typename KeyFunc>
+		void Sort(KeyFunc&& key, std::uint32_t layoutVersion = 0)
+		{
+			std::sort(m_Dense.begin(), m_Dense.end(),
+				[&key](Entity lhs, Entity rhs) { return key(lhs) < key(rhs); });
+
+			for (std::size_t i = 0; i < m_Dense.size(); ++i)
+				m_Sparse.Set(m_Dense[i], static_cast<SparseIndex::Index>(i));
+
+			m_SortedLayout = layoutVersion;
+			m_Dirty = false;
+		}
+
+	private:
+
+		SparseIndex m_Sparse{};
+		std::vector<Entity> m_Dense{};
+		std::uint32_t m_SortedLayout = 0;
+		bool m_Dirty = false;
+	};
+}
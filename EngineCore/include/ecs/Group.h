@@ -0,0 +1,149 @@
+#pragma once
+
+#include <span>
+#include <tuple>
+#include <cstddef>
+#include <cstdint>
+#include "ecs/Entity.h"
+#include "ecs/Component.h"
+#include "ecs/Signature.h"
+#include "ecs/SparseIndex.h"
+#include "ecs/ComponentArray.h"
+#include "ecs/SoAComponentArray.h"
+
+namespace ecs {
+
+	/** Moves the entity's component to a packed position, swapping with the one there */
+	template<typename Array>
+	inline void SwapToSlot(Array& array, Entity entity, std::size_t slot)
+	{
+		const std::size_t index = array.GetIndex(entity);
+
+		if (index != slot)
+			array.SwapSlots(slot, index);
+	}
+
+	// -----------------------------------------
+	// Owning Group
+	// -----------------------------------------
+
+	/// An owning group keeps the packed arrays of its components co-sorted:
+	/// the entities that have all of them sit in the first Size() slots of
+	/// every array, in the same order. Iterating the group is then a
+	/// lockstep walk over the arrays with no sparse lookup at all.
+	///
+	/// The prefix is maintained incrementally by the ComponentManager:
+	/// an entity completing the set is swapped in at the end of the prefix,
+	/// one about to lose a component is swapped out of it first, so the
+	/// swap-remove of ComponentArray only ever touches slots past the prefix.
+	///
+	/// A group owns its arrays: no other group (or anything else that
+	/// reorders slots) may share them.
+
+	class IGroup
+	{
+	public:
+
+		virtual ~IGroup() = default;
+
+		/** An owned component was added to each of the entities */
+		virtual void ComponentsAdded(std::span<const Entity> entities) = 0;
+
+		/** An owned component is about to be removed from each of the entities */
+		virtual void ComponentsRemoving(std::span<const Entity> entities) = 0;
+
+		std::size_t Size() const { return m_Size; }
+		const Signature& GetSignature() const { return m_Signature; }
+
+	protected:
+
+		explicit IGroup(const Signature& signature) : m_Signature(signature) {}
+
+		// Number of entities in the group, the shared prefix of the arrays
+		std::size_t m_Size = 0;
+		Signature m_Signature{};
+	};
+
+	template<typename... Ts>
+	class OwningGroup : public IGroup
+	{
+		static_assert(sizeof...(Ts) > 1, "A group needs at least two component types.");
+
+	public:
+
+		/** Builds the prefix from the components that already exist */
+		explicit OwningGroup(ComponentStorage<Ts>*... arrays);
+
+		void ComponentsAdded(std::span<const Entity> entities) override;
+		void ComponentsRemoving(std::span<const Entity> entities) override;
+
+	private:
+
+		std::tuple<ComponentStorage<Ts>*...> m_Arrays;
+
+		bool HasAll(Entity entity) const
+		{
+			return std::apply([entity](auto*... arrays) { return (arrays->Contains(entity) && ...); }, m_Arrays);
+		}
+
+		bool InPrefix(Entity entity) const
+		{
+			return std::get<0>(m_Arrays)->Find(entity) < m_Size;
+		}
+
+		void SwapAllToSlot(Entity entity, std::size_t slot)
+		{
+			std::apply([entity, slot](auto*... arrays) { (SwapToSlot(*arrays, entity, slot), ...); }, m_Arrays);
+		}
+	};
+
+	/// ----------------------------------------------
+	/// OwningGroup Ctor
+	/// ----------------------------------------------
+
+	template<typename... Ts>
+	inline OwningGroup<Ts...>::OwningGroup(ComponentStorage<Ts>*... arrays)
+		: IGroup(MakeSignature<Ts...>()), m_Arrays(arrays...)
+	{
+		auto* lead = std::get<0>(m_Arrays);
+
+		// Slots below m_Size already hold group members, so the next one is at m_Size or after
+		for (std::size_t i = 0; i < lead->Size(); ++i)
+		{
+			const Entity entity = lead->GetEntities()[i];
+
+			if (HasAll(entity))
+				SwapAllToSlot(entity, m_Size++);
+		}
+	}
+
+	/// ----------------------------------------------
+	/// OwningGroup::ComponentsAdded
+	/// ----------------------------------------------
+
+	template<typename... Ts>
+	inline void OwningGroup<Ts...>::ComponentsAdded(std::span<const Entity> entities)
+	{
+		for (Entity entity : entities)
+		{
+			// The new component was just pushed past the prefix, so the entity can't be in it yet
+			if (HasAll(entity))
+				SwapAllToSlot(entity, m_Size++);
+		}
+	}
+
+	/// ----------------------------------------------
+	/// OwningGroup::ComponentsRemoving
+	/// ----------------------------------------------
+
+	template<typename... Ts>
+	inline void OwningGroup<Ts...>::ComponentsRemoving(std::span<const Entity> entities)
+	{
+		for (Entity entity : entities)
+		{
+			// Swap with the last member and shrink the prefix
+			if (InPrefix(entity))
+				SwapAllToSlot(entity, --m_Size);
+		}
+	}
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+#include "ecs/Entity.h"
+#include "ecs/Component.h"
+#include "ecs/Signature.h"
+#include "ecs/SparseIndex.h"
+
+namespace ecs {
+
+	enum class ObserverEvent : std::uint8_t { Add, Remove, Set };
+
+	/** Receives every entity of one batch at once */
+	using ObserverCallback = std::function<void(std::span<const Entity>)>;
+	using ObserverID = std::uint32_t;
+
+	// -----------------------------------------
+	// Observer Manager
+	// -----------------------------------------
+
+	/// Queues component adds, removes and sets per type, and delivers them
+	/// to the registered callbacks in batches with Flush(), at a sync point.
+	/// Nothing is recorded for a type nobody observes.
+	///
+	/// Events are coalesced per entity until the flush, so a batch holds
+	/// the net changes: a component added and removed in between is not
+	/// reported at all, an added one is not reported as set too, and an
+	/// entity appears at most once in an add or set batch. Entities of an
+	/// add or set batch are alive and have the component when delivered.
+	///
+	/// For each type, removes are delivered first, then adds, then sets.
+	/// A flush delivers what was queued when it started: events raised by
+	/// the callbacks themselves wait for the next flush, whatever their type.
+	/// A component a callback removes is dropped from the add and set
+	/// batches of this flush that are not delivered yet.
+	/// Sets may be reported from several threads at once, adds and removes
+	/// only come from structural changes, which run alone.
+	/// Callbacks must not register or unregister observers.
+
+	class ObserverManager
+	{
+	public:
+
+		ObserverID Register(ObserverEvent event, ComponentType type, ObserverCallback callback);
+		void Unregister(ObserverID id);
+
+		/** True if any event of the type is observed, the Coordinator skips the others */
+		bool IsObserved(ComponentType type) const { return m_ObservedTypes.test(type); }
+
+		void ComponentAdded(ComponentType type, Entity entity);
+		void ComponentRemoved(ComponentType type, Entity entity);
+		void ComponentSet(ComponentType type, Entity entity);
+
+		/** Removal of every observed component of the signature */
+		void EntityDestroyed(Entity entity, const Signature& signature);
+
+		/** Calls the callbacks with the queued batches */
+		void Flush();
+
+	private:
+
+		static constexpr std::size_t EVENT_COUNT = 3;
+
+		struct Observer
+		{
+			ObserverID id;
+			ObserverCallback callback;
+		};
+
+		// Pending entities of one event, the index coalesces them
+		struct Queue
+		{
+			SparseIndex index{};
+			std::vector<Entity> entities{};
+
+			bool Contains(Entity entity) const { return index.Contains(entity); }
+			void Push(Entity entity);
+			void Erase(Entity entity);
+		};
+
+		// Indexed by ObserverEvent, then by ComponentType
+		std::array<std::array<std::vector<Observer>, MAX_COMPONENTS>, EVENT_COUNT> m_Observers{};
+		std::array<std::array<Queue, MAX_COMPONENTS>, EVENT_COUNT> m_Queues{};
+
+		// What the flush in progress delivers, swapped with m_Queues when it starts
+		std::array<std::array<Queue, MAX_COMPONENTS>, EVENT_COUNT> m_Flushing{};
+		std::array<Signature, EVENT_COUNT> m_Observed{};
+		Signature m_ObservedTypes{};
+
+		// Types with something queued, like CommandBuffer's used pools
+		std::vector<ComponentType> m_PendingTypes{};
+		Signature m_Pending{};
+
+		std::mutex m_SetMutex;
+
+		// Batch being delivered, swapped with a flushing queue
+		std::vector<Entity> m_Delivering{};
+
+		ObserverID m_NextID = 0;
+
+		Queue& GetQueue(ObserverEvent event, ComponentType type);
+		void Deliver(ObserverEvent event, ComponentType type);
+	};
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+#include <vector>
+#include <new>
+#include <memory>
+#include <utility>
+#include <cstddef>
+#include <cassert>
+#include "ecs/Component.h"
+
+namespace ecs {
+
+	/// Growable array that allocates its storage in fixed-size pages.
+	///
+	/// Growing never moves existing elements (a new page is appended),
+	/// so references stay valid as the array grows. Pages are released
+	/// again when the array shrinks, keeping at most one spare page at
+	/// the tail to avoid allocation ping-pong around a page boundary.
+	/// Pages are cache-line aligned.
+
+	template<typename T, std::size_t PageSize = 1024>
+	class PagedArray
+	{
+		static_assert((PageSize & (PageSize - 1)) == 0, "PageSize must be a power of two.");
+
+	public:
+
+		static constexpr std::size_t PAGE_SIZE = PageSize;
+		static constexpr std::size_t PAGE_ALIGNMENT = alignof(T) > 64 ? alignof(T) : 64;
+
+		PagedArray() = default;
+		~PagedArray();
+
+		PagedArray(const PagedArray&) = delete;
+		PagedArray& operator=(const PagedArray&) = delete;
+
+		PagedArray(PagedArray&& other) noexcept
+			: m_Pages(std::move(other.m_Pages)), m_Size(std::exchange(other.m_Size, 0)) {}
+
+		PagedArray& operator=(PagedArray&& other) noexcept
+		{
+			if (this != &other)
+			{
+				Clear();
+				ReleaseUnusedPages(0);
+				m_Pages = std::move(other.m_Pages);
+				m_Size = std::exchange(other.m_Size, 0);
+			}
+			return *this;
+		}
+
+		T& operator[](std::size_t index)
+		{
+			assert(index < m_Size && "PagedArray index out of range.");
+			return m_Pages[index / PAGE_SIZE][index % PAGE_SIZE];
+		}
+
+		const T& operator[](std::size_t index) const
+		{
+			assert(index < m_Size && "PagedArray index out of range.");
+			return m_Pages[index / PAGE_SIZE][index % PAGE_SIZE];
+		}
+
+		std::size_t Size() const { return m_Size; }
+		bool Empty() const { return m_Size == 0; }
+		std::size_t Capacity() const { return m_Pages.size() * PAGE_SIZE; }
+
+		/** Pages allocated and pointer to the first element of a page */
+		std::size_t PageCount() const { return m_Pages.size(); }
+		T* PageData(std::size_t page) { return m_Pages[page]; }
+		const T* PageData(std::size_t page) const { return m_Pages[page]; }
+
+		/** Makes sure there is room for at least capacity elements */
+		void Reserve(std::size_t capacity);
+
+		template<typename... Args>
+		T& EmplaceBack(Args&&... args);
+
+		void PushBack(const T& value) { EmplaceBack(value); }
+		void PushBack(T&& value) { EmplaceBack(std::move(value)); }
+
+		/** Appends count copies of value, filling each page in one go (see FillConstruct) */
+		void AppendCopies(std::size_t count, const T& value);
+
+		void PopBack();
+		void Clear();
+
+	private:
+
+		std::vector<T*> m_Pages{};
+		std::size_t m_Size = 0;
+
+		void ReleaseUnusedPages(std::size_t sparePages);
+	};
+
+	/// ----------------------------------------------
+	/// Dtor
+	/// ----------------------------------------------
+
+	template<typename T, std::size_t PageSize>
+	inline PagedArray<T, PageSize>::~PagedArray()
+	{
+		Clear();
+		ReleaseUnusedPages(0);
+	}
+
+	/// ----------------------------------------------
+	/// Reserve
+	/// ----------------------------------------------
+
+	template<typename T, std::size_t PageSize>
+	inline void PagedArray<T, PageSize>::Reserve(std::size_t capacity)
+	{
+		while (Capacity() < capacity)
+		{
+			void* page = ::operator new(sizeof(T) * PAGE_SIZE, std::align_val_t{ PAGE_ALIGNMENT });
+			m_Pages.push_back(static_cast<T*>(page));
+		}
+	}
+
+	/// ----------------------------------------------
+	/// EmplaceBack
+	/// ----------------------------------------------
+
+	template<typename T, std::size_t PageSize>
+	template<typename... Args>
+	inline T& PagedArray<T, PageSize>::EmplaceBack(Args&&... args)
+	{
+		Reserve(m_Size + 1);
+
+		T* slot = m_Pages[m_Size / PAGE_SIZE] + (m_Size % PAGE_SIZE);
+		::new (static_cast<void*>(slot)) T(std::forward<Args>(args)...);
+		++m_Size;
+
+		return *slot;
+	}
+
+	/// ----------------------------------------------
+	/// AppendCopies
+	/// ----------------------------------------------
+
+	template<typename T, std::size_t PageSize>
+	inline void PagedArray<T, PageSize>::AppendCopies(std::size_t count, const T& value)
+	{
+		Reserve(m_Size + count);
+
+		while (count > 0)
+		{
+			const std::size_t offset = m_Size % PAGE_SIZE;
+			const std::size_t n = count < PAGE_SIZE - offset ? count : PAGE_SIZE - offset;
+
+			FillConstruct(m_Pages[m_Size / PAGE_SIZE] + offset, value, n);
+			m_Size += n;
+			count -= n;
+		}
+	}
+
+	/// ----------------------------------------------
+	/// PopBack
+	/// ----------------------------------------------
+
+	template<typename T, std::size_t PageSize>
+	inline void PagedArray<T, PageSize>::PopBack()
+	{
+		assert(m_Size > 0 && "PopBack on empty PagedArray.");
+
+		--m_Size;
+		std::destroy_at(m_Pages[m_Size / PAGE_SIZE] + (m_Size % PAGE_SIZE));
+
+		ReleaseUnusedPages(1);
+	}
+
+	/// ----------------------------------------------
+	/// Clear
+	/// ----------------------------------------------
+
+	template<typename T, std::size_t PageSize>
+	inline void PagedArray<T, PageSize>::Clear()
+	{
+		for (std::size_t i = 0; i < m_Size; ++i)
+			std::destroy_at(m_Pages[i / PAGE_SIZE] + (i % PAGE_SIZE));
+
+		m_Size = 0;
+	}
+
+	/// ----------------------------------------------
+	/// ReleaseUnusedPages
+	/// ----------------------------------------------
+
+	template<typename T, std::size_t PageSize>
+	inline void PagedArray<T, PageSize>::ReleaseUnusedPages(std::size_t sparePages)
+	{
+		const std::size_t usedPages = (m_Size + PAGE_SIZE - 1) / PAGE_SIZE;
+
+		while (m_Pages.size() > usedPages + sparePages)
+		{
+			::operator delete(m_Pages.back(), std::align_val_t{ PAGE_ALIGNMENT });
+			m_Pages.pop_back();
+		}
+	}
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <new>
+#include <numeric>
+#include <algorithm>
+#include <cstddef>
+#include "core/jobs/JobSystem.h"
+
+namespace ecs {
+
+	// -----------------------------------------
+	// Parallel Iteration
+	// -----------------------------------------
+
+	/// Helpers for the Parallel* iteration of the Coordinator and View.
+	///
+	/// A dense range is cut into jobs at cache line boundaries of the arrays
+	/// being written, so two threads never write to the same line (false
+	/// sharing makes the line bounce between the cores on every store).
+	/// This holds as long as each array starts on a line: PagedArray pages
+	/// do, and the SoA columns use CacheAlignedAllocator.
+
+	inline constexpr std::size_t CACHE_LINE_SIZE = 64;
+
+	/** Elements per job at least, smaller ranges aren't worth a thread */
+	inline constexpr std::size_t PARALLEL_MIN_CHUNK = 1024;
+
+	/// Smallest element count that is a whole number of cache lines in an
+	/// array of every one of Ts: cutting a line-aligned array every that
+	/// many elements always cuts on a line boundary.
+	template<typename... Ts>
+	constexpr std::size_t ElementsPerCacheLine()
+	{
+		std::size_t elements = 1;
+		((elements = std::lcm(elements, CACHE_LINE_SIZE / std::gcd(CACHE_LINE_SIZE, sizeof(Ts)))), ...);
+		return elements;
+	}
+
+	/// Calls func(begin, end) over [0, count) on the job system, cut in
+	/// ranges that are multiples of alignment elements (but the last one).
+	/// func runs concurrently on several threads.
+	template<typename Func>
+	void ParallelForAligned(core::JobSystem& jobs, std::size_t count, std::size_t alignment, Func&& func)
+	{
+		const std::size_t blocks = (count + alignment - 1) / alignment;
+		const std::size_t minBlocks = std::max<std::size_t>(1, PARALLEL_MIN_CHUNK / alignment);
+
+		jobs.ParallelFor(blocks, minBlocks, [&func, count, alignment](std::size_t begin, std::size_t end) {
+			func(begin * alignment, std::min(count, end * alignment));
+		});
+	}
+
+	/// Allocator of std::vectors whose elements are written by parallel jobs:
+	/// the storage starts on a cache line and is rounded up to whole lines,
+	/// so no line is shared with another allocation.
+	template<typename T>
+	struct CacheAlignedAllocator
+	{
+		using value_type = T;
+
+		CacheAlignedAllocator() = default;
+
+		template<typename U>
+		CacheAlignedAllocator(const CacheAlignedAllocator<U>&) noexcept {}
+
+		T* allocate(std::size_t count)
+		{
+			const std::size_t size = (count * sizeof(T) + CACHE_LINE_SIZE - 1) & ~(CACHE_LINE_SIZE - 1);
+			return static_cast<T*>(::operator new(size, std::align_val_t{ CACHE_LINE_SIZE }));
+		}
+
+		void deallocate(T* data, std::size_t) noexcept
+		{
+			::operator delete(data, std::align_val_t{ CACHE_LINE_SIZE });
+		}
+
+		template<typename U>
+		bool operator==(const CacheAlignedAllocator<U>&) const noexcept { return true; }
+	};
+}
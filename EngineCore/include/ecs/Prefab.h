@@ -0,0 +1,107 @@
+#pragma once
+
+#include <vector>
+#include <span>
+#include <cassert>
+#include "ecs/Component.h"
+#include "ecs/Signature.h"
+
+namespace ecs {
+
+	// -----------------------------------------
+	// Prefab
+	// -----------------------------------------
+
+	/// A full component set kept aside to stamp out copies of an entity.
+	/// Build one by hand or capture a living entity once:
+	///
+	///		ecs::Prefab bullet = coordinator.CreatePrefab(templateEntity);
+	///		bullet.Set(ecs::Velocity{ 8.0f, 0.0f });
+	///		auto bullets = coordinator.Instantiate(bullet, 500);
+	///
+	/// Components are held by type ID through their ComponentInfo, so that
+	/// instantiating needs no template parameters: each component becomes
+	/// one bulk copy into its storage (see FillConstruct) and the new
+	/// entities get their signature and systems in a single pass.
+	/// Tags are only bits in the prefab signature.
+
+	class Prefab
+	{
+	public:
+
+		/** A component value held by the prefab */
+		struct Component
+		{
+			ComponentType type = 0;
+			ComponentInfo info{};
+			void* data = nullptr;
+		};
+
+		Prefab() = default;
+		~Prefab();
+
+		Prefab(const Prefab& other);
+		Prefab& operator=(const Prefab& other);
+
+		Prefab(Prefab&& other) noexcept;
+		Prefab& operator=(Prefab&& other) noexcept;
+
+		/** Adds the component, or overwrites the value already there */
+		template<typename T>
+		Prefab& Set(const T& component)
+		{
+			if constexpr (IsTagComponent<T>)
+				SetTag(GetComponentTypeID<T>());
+			else
+				Set(GetComponentTypeID<T>(), MakeComponentInfo<T>(), &component);
+
+			return *this;
+		}
+
+		/** Type-erased Set: copies the value at component, described by info */
+		void Set(ComponentType type, const ComponentInfo& info, const void* component);
+
+		/** Storage for the value of a component, left for the caller to construct */
+		void* Emplace(ComponentType type, const ComponentInfo& info);
+
+		void SetTag(ComponentType type) { m_Signature.set(type); }
+
+		template<typename T>
+		void Remove() { Remove(GetComponentTypeID<T>()); }
+
+		void Remove(ComponentType type);
+
+		template<typename T>
+		bool Has() const { return m_Signature.test(GetComponentTypeID<T>()); }
+
+		template<typename T>
+		const T& Get() const
+		{
+			static_assert(!IsTagComponent<T>, "Tag components have no data, use Has.");
+
+			const Component* component = Find(GetComponentTypeID<T>());
+
+			assert(component && "Retrieving non-existent prefab component.");
+
+			return *static_cast<const T*>(component->data);
+		}
+
+		/** Every component type of the prefab, tags included */
+		const Signature& GetSignature() const { return m_Signature; }
+
+		/** The components that carry data, in type order */
+		std::span<const Component> GetComponents() const { return m_Components; }
+
+	private:
+
+		// Sorted by type, each value in its own allocation
+		std::vector<Component> m_Components{};
+		Signature m_Signature{};
+
+		const Component* Find(ComponentType type) const;
+
+		static void* Allocate(const ComponentInfo& info);
+		static void Release(Component& component);
+		void Clear();
+	};
+}
@@ -0,0 +1,208 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <vector>
+#include <memory>
+#include <string>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+#include "ecs/Component.h"
+#include "ecs/Signature.h"
+#include "ecs/Coordinator.h"
+#include "ecs/CommandBuffer.h"
+#include "core/jobs/JobSystem.h"
+
+namespace ecs {
+
+	// -----------------------------------------
+	// System Access
+	// -----------------------------------------
+
+	/// The components a system reads and writes, which is all the Scheduler
+	/// knows about it. Like with View, const means read-only:
+	///
+	///		static constexpr SystemAccess ACCESS = SystemAccess::Of<Transform, const Velocity>();
+	///
+	/// A deferred system records structural changes in its CommandBuffer:
+	/// declare the components it adds or removes as written, so that the
+	/// systems using them wait for the changes to be applied.
+
+	struct SystemAccess
+	{
+		Signature reads{};
+		Signature writes{};
+		bool deferred = false;
+
+		template<typename... Ts>
+		static constexpr SystemAccess Of(bool deferred = false)
+		{
+			SystemAccess access;
+			access.deferred = deferred;
+			((std::is_const_v<Ts> ? void(access.reads.set(GetComponentTypeID<std::remove_const_t<Ts>>()))
+				: void(access.writes.set(GetComponentTypeID<std::remove_const_t<Ts>>()))), ...);
+			return access;
+		}
+
+		/** True if the two can't run at the same time: one writes what the other uses */
+		bool ConflictsWith(const SystemAccess& other) const
+		{
+			return writes.Intersects(other.reads | other.writes) || other.writes.Intersects(reads);
+		}
+	};
+
+	/** What a scheduled system gets to run */
+	struct SystemContext
+	{
+		Coordinator& coordinator;
+		core::JobSystem& jobs;
+		CommandBuffer& commands;
+		float deltaTime;
+	};
+
+	using SystemFunction = std::function<void(SystemContext&)>;
+
+	// -----------------------------------------
+	// Schedule Report
+	// -----------------------------------------
+
+	/// Timings of the last Scheduler::Run. The critical path is the chain
+	/// of dependent systems (and sync points) that took the longest: no
+	/// thread count can make the frame shorter than that, so shortening or
+	/// splitting the systems on it is what buys more parallelism.
+
+	struct ScheduleReport
+	{
+		struct SystemTiming
+		{
+			std::string name;
+			std::uint32_t phase = 0;
+			double startMs = 0.0;		// since the start of Run
+			double durationMs = 0.0;
+			bool critical = false;
+		};
+
+		std::vector<SystemTiming> systems{};		// in the order they were added
+		std::vector<std::size_t> criticalPath{};	// indices in systems, in run order
+
+		double frameMs = 0.0;
+		double workMs = 0.0;			// every system's duration summed
+		double criticalPathMs = 0.0;	// sync points included
+		double syncMs = 0.0;
+		std::uint32_t syncPoints = 0;
+
+		/** How many systems ran at once on average: work / critical path */
+		double GetParallelism() const { return criticalPathMs > 0.0 ? workMs / criticalPathMs : 0.0; }
+
+		/** Longest system on the critical path, the one limiting the frame (nullptr if none ran) */
+		const SystemTiming* GetBottleneck() const;
+
+		/** One line per system, critical ones marked with '*' */
+		std::string Format() const;
+	};
+
+	// -----------------------------------------
+	// Scheduler
+	// -----------------------------------------
+
+	/// Runs systems on the job system, as many at once as their declared
+	/// accesses allow. Systems are added in the order they would run on a
+	/// single thread, and each one depends on the earlier ones it
+	/// conflicts with (see SystemAccess): the dependencies form a DAG that
+	/// is rebuilt when systems are added, and each system is queued as a
+	/// job as soon as the last of them is done.
+	///
+	///		scheduler.Add<MovementSystem>("Movement", [&](SystemContext& context) { movement->Update(context.coordinator, context.jobs, context.deltaTime); });
+	///		scheduler.Run(coordinator, jobs, deltaTime);
+	///
+	/// Each system gets its own CommandBuffer. The systems are split in
+	/// phases: a system that depends on a deferred one goes to a later
+	/// phase, and between two phases (and at the end of Run) the phase's
+	/// buffers are flushed in the order the systems were added. Those are
+	/// the sync points: nothing else runs meanwhile. The entities reserved
+	/// during the phase (Coordinator::ReserveEntity) come alive there too.
+	///
+	/// The change tick advances before each phase and stays put while it
+	/// runs, systems record Coordinator::GetTick() as their last run. So a
+	/// system writing what an earlier one uses goes to a later phase too,
+	/// otherwise its changes would carry the tick the earlier one recorded
+	/// and be missed by it.
+	///
+	/// Systems of a phase run concurrently: besides their accesses they
+	/// must not share state, nor make structural changes other than
+	/// through their buffer. A system that waits on its own jobs (a
+	/// ParallelFor) may run other systems' jobs meanwhile, which then
+	/// count in its duration.
+
+	class Scheduler
+	{
+	public:
+
+		/** Adds a system type that declares its ACCESS */
+		template<typename T>
+		void Add(std::string name, SystemFunction function)
+		{
+			Add(std::move(name), T::ACCESS, std::move(function));
+		}
+
+		void Add(std::string name, const SystemAccess& access, SystemFunction function);
+
+		/** Runs every system once and returns after the last sync point */
+		void Run(Coordinator& coordinator, core::JobSystem& jobs, float deltaTime);
+
+		/** Timings of the last Run */
+		const ScheduleReport& GetReport() const { return m_Report; }
+
+		std::size_t GetSystemCount() const { return m_Nodes.size(); }
+
+	private:
+
+		using Clock = std::chrono::steady_clock;
+
+		struct Node
+		{
+			std::string name;
+			SystemAccess access;
+			SystemFunction function;
+			CommandBuffer commands{};
+
+			std::uint32_t phase = 0;
+
+			// Dependencies inside the phase, the earlier phases are done anyway
+			std::vector<std::uint32_t> predecessors{};
+			std::vector<std::uint32_t> successors{};
+			std::atomic<std::uint32_t> pending{ 0 };
+
+			Clock::time_point start{};
+			Clock::time_point end{};
+		};
+
+		/** State of the Run in progress, for the jobs */
+		struct Frame
+		{
+			Coordinator* coordinator = nullptr;
+			core::JobSystem* jobs = nullptr;
+			core::JobCounter* counter = nullptr;
+			float deltaTime = 0.0f;
+		};
+
+		std::vector<std::unique_ptr<Node>> m_Nodes{};
+		std::vector<std::vector<std::uint32_t>> m_Phases{};
+		bool m_Dirty = false;
+
+		Frame m_Frame{};
+		ScheduleReport m_Report{};
+
+		/** Dependencies and phases from the declared accesses */
+		void Build();
+
+		void RunPhase(const std::vector<std::uint32_t>& phase);
+
+		/** Job body: runs the system, then queues the successors it was the last one holding */
+		void RunNode(std::uint32_t index);
+
+		void BuildReport(Clock::time_point frameStart, Clock::time_point frameEnd, const std::vector<double>& syncMs);
+	};
+}
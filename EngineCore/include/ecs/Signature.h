@@ -0,0 +1,260 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include <bit>
+#include <functional>
+#include "ecs/Component.h"
+
+// Pick the widest mask test the target is compiled for.
+// MSVC defines __AVX__/__AVX2__ with /arch:AVX(2) and always has SSE2 on x64.
+#if defined(__AVX__) || defined(__AVX2__)
+	#include <immintrin.h>
+	#define ECS_SIGNATURE_AVX 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+	#include <emmintrin.h>
+	#define ECS_SIGNATURE_SSE2 1
+#endif
+
+namespace ecs {
+
+	/// Fixed-width component mask, one bit per ComponentType.
+	///
+	/// Drop-in replacement for std::bitset<MAX_COMPONENTS> (same set/reset/test
+	/// names) stored as 64-bit words aligned for SIMD loads. The hot operation,
+	/// "does this entity have every component a system needs", is Contains():
+	/// a single vptest per 256 bits with AVX, and an and/compare/movemask per
+	/// 128 bits with plain SSE2, instead of a word-by-word loop.
+
+	class Signature
+	{
+	public:
+
+		static constexpr std::size_t BITS = MAX_COMPONENTS;
+		static constexpr std::size_t WORDS = BITS / 64;
+
+		static_assert(BITS % 128 == 0, "MAX_COMPONENTS must be a multiple of 128.");
+
+		constexpr Signature() = default;
+
+		constexpr Signature& set(std::size_t pos, bool value = true)
+		{
+			assert(pos < BITS && "Signature bit out of range.");
+
+			if (value)
+				m_Words[pos / 64] |= (std::uint64_t(1) << (pos % 64));
+			else
+				m_Words[pos / 64] &= ~(std::uint64_t(1) << (pos % 64));
+
+			return *this;
+		}
+
+		constexpr Signature& reset(std::size_t pos) { return set(pos, false); }
+
+		constexpr Signature& reset()
+		{
+			for (auto& word : m_Words)
+				word = 0;
+			return *this;
+		}
+
+		constexpr bool test(std::size_t pos) const
+		{
+			assert(pos < BITS && "Signature bit out of range.");
+			return (m_Words[pos / 64] >> (pos % 64)) & 1;
+		}
+
+		constexpr std::size_t size() const { return BITS; }
+
+		bool any() const { return !none(); }
+		bool none() const { return *this == Signature{}; }
+
+		std::size_t count() const
+		{
+			std::size_t bits = 0;
+			for (auto word : m_Words)
+				for (; word; word &= word - 1)
+					++bits;
+			return bits;
+		}
+
+		/** True if every bit set in other is also set here: (*this & other) == other */
+		bool Contains(const Signature& other) const;
+
+		/** True if at least one bit is set in both */
+		bool Intersects(const Signature& other) const;
+
+		std::uint64_t GetWord(std::size_t index) const { return m_Words[index]; }
+
+		/** Calls func(type) for every set bit, in increasing order */
+		template<typename Func>
+		void ForEachSet(Func&& func) const
+		{
+			for (std::size_t i = 0; i < WORDS; ++i)
+			{
+				for (std::uint64_t bits = m_Words[i]; bits; bits &= bits - 1)
+					func(static_cast<ComponentType>(i * 64 + std::countr_zero(bits)));
+			}
+		}
+
+		constexpr Signature operator&(const Signature& other) const
+		{
+			Signature result;
+			for (std::size_t i = 0; i < WORDS; ++i)
+				result.m_Words[i] = m_Words[i] & other.m_Words[i];
+			return result;
+		}
+
+		constexpr Signature operator|(const Signature& other) const
+		{
+			Signature result;
+			for (std::size_t i = 0; i < WORDS; ++i)
+				result.m_Words[i] = m_Words[i] | other.m_Words[i];
+			return result;
+		}
+
+		constexpr Signature& operator&=(const Signature& other) { return *this = *this & other; }
+		constexpr Signature& operator|=(const Signature& other) { return *this = *this | other; }
+
+		bool operator==(const Signature& other) const;
+		bool operator!=(const Signature& other) const { return !(*this == other); }
+
+		std::size_t Hash() const
+		{
+			// FNV-1a over the words
+			std::uint64_t hash = 14695981039346656037ull;
+			for (auto word : m_Words)
+				hash = (hash ^ word) * 1099511628211ull;
+			return static_cast<std::size_t>(hash);
+		}
+
+	private:
+
+		alignas(32) std::uint64_t m_Words[WORDS]{};
+	};
+
+	/// Signature with the bits of the given component types, usable in
+	/// constant expressions since the IDs are compile-time constants:
+	///
+	///		constexpr Signature required = MakeSignature<Transform, Velocity>();
+	template<typename... Ts>
+	constexpr Signature MakeSignature()
+	{
+		Signature signature;
+		(signature.set(GetComponentTypeID<Ts>()), ...);
+		return signature;
+	}
+
+	/** Like MakeSignature() but only with the types that have storage (no tags) */
+	template<typename... Ts>
+	constexpr Signature MakeStorageSignature()
+	{
+		Signature signature;
+		((IsTagComponent<Ts> ? void() : void(signature.set(GetComponentTypeID<Ts>()))), ...);
+		return signature;
+	}
+
+	/// ----------------------------------------------
+	/// Contains
+	/// ----------------------------------------------
+
+	inline bool Signature::Contains(const Signature& other) const
+	{
+#if defined(ECS_SIGNATURE_AVX)
+		for (std::size_t i = 0; i < WORDS; i += 4)
+		{
+			const __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(m_Words + i));
+			const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(other.m_Words + i));
+
+			// CF = ((~a & b) == 0)
+			if (!_mm256_testc_si256(a, b))
+				return false;
+		}
+		return true;
+#elif defined(ECS_SIGNATURE_SSE2)
+		for (std::size_t i = 0; i < WORDS; i += 2)
+		{
+			const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(m_Words + i));
+			const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.m_Words + i));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_and_si128(a, b), b)) != 0xFFFF)
+				return false;
+		}
+		return true;
+#else
+		std::uint64_t missing = 0;
+		for (std::size_t i = 0; i < WORDS; ++i)
+			missing |= ~m_Words[i] & other.m_Words[i];
+		return missing == 0;
+#endif
+	}
+
+	/// ----------------------------------------------
+	/// Intersects
+	/// ----------------------------------------------
+
+	inline bool Signature::Intersects(const Signature& other) const
+	{
+#if defined(ECS_SIGNATURE_AVX)
+		for (std::size_t i = 0; i < WORDS; i += 4)
+		{
+			const __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(m_Words + i));
+			const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(other.m_Words + i));
+
+			// ZF = ((a & b) == 0)
+			if (!_mm256_testz_si256(a, b))
+				return true;
+		}
+		return false;
+#else
+		std::uint64_t common = 0;
+		for (std::size_t i = 0; i < WORDS; ++i)
+			common |= m_Words[i] & other.m_Words[i];
+		return common != 0;
+#endif
+	}
+
+	/// ----------------------------------------------
+	/// operator==
+	/// ----------------------------------------------
+
+	inline bool Signature::operator==(const Signature& other) const
+	{
+#if defined(ECS_SIGNATURE_AVX)
+		for (std::size_t i = 0; i < WORDS; i += 4)
+		{
+			const __m256i a = _mm256_load_si256(reinterpret_cast<const __m256i*>(m_Words + i));
+			const __m256i b = _mm256_load_si256(reinterpret_cast<const __m256i*>(other.m_Words + i));
+
+			// float xor is AVX, the integer one needs AVX2
+			const __m256i diff = _mm256_castps_si256(_mm256_xor_ps(_mm256_castsi256_ps(a), _mm256_castsi256_ps(b)));
+
+			if (!_mm256_testz_si256(diff, diff))
+				return false;
+		}
+		return true;
+#elif defined(ECS_SIGNATURE_SSE2)
+		for (std::size_t i = 0; i < WORDS; i += 2)
+		{
+			const __m128i a = _mm_load_si128(reinterpret_cast<const __m128i*>(m_Words + i));
+			const __m128i b = _mm_load_si128(reinterpret_cast<const __m128i*>(other.m_Words + i));
+
+			if (_mm_movemask_epi8(_mm_cmpeq_epi8(a, b)) != 0xFFFF)
+				return false;
+		}
+		return true;
+#else
+		std::uint64_t diff = 0;
+		for (std::size_t i = 0; i < WORDS; ++i)
+			diff |= m_Words[i] ^ other.m_Words[i];
+		return diff == 0;
+#endif
+	}
+}
+
+template<>
+struct std::hash<ecs::Signature>
+{
+	std::size_t operator()(const ecs::Signature& signature) const noexcept { return signature.Hash(); }
+};
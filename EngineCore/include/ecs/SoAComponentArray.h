@@ -0,0 +1,483 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <span>
+#include <cstring>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <functional>
+#include <type_traits>
+#include <cassert>
+#include "ecs/Entity.h"
+#include "ecs/Component.h"
+#include "ecs/SparseIndex.h"
+#include "ecs/ComponentArray.h"
+#include "ecs/PagedArray.h"
+#include "ecs/Parallel.h"
+
+namespace ecs {
+
+	/// Elements per page of the SoA columns and of their change ticks: a
+	/// whole number of cache lines, so the pages start on lines like the
+	/// ranges ParallelForAligned cuts. A column is only contiguous within
+	/// a page, column kernels get one run per page (see GetColumns).
+	constexpr std::size_t SOA_PAGE_SIZE = 1024;
+
+	template<typename T>
+	class SoAComponentArray;
+
+	// -----------------------------------------
+	// SoA Columns
+	// -----------------------------------------
+
+	/// What a column kernel receives for one SoA component: one float
+	/// array per field, all of the same length and in the same entity order.
+	/// SoAColumns<const T> gives read-only arrays.
+	///
+	///		std::span<float> rotationY = transform.Field(ECS_SOA_FIELD(Transform, rotation.y));
+
+	template<typename T>
+	class SoAColumns
+	{
+		using Component = std::remove_const_t<T>;
+		using Float = std::conditional_t<std::is_const_v<T>, const float, float>;
+
+	public:
+
+		static constexpr std::size_t FIELD_COUNT = sizeof(Component) / sizeof(float);
+
+		SoAColumns(const std::array<Float*, FIELD_COUNT>& fields, std::size_t size)
+			: m_Fields(fields), m_Size(size) {}
+
+		std::size_t Size() const { return m_Size; }
+
+		std::span<Float> Field(std::size_t field) const
+		{
+			assert(field < FIELD_COUNT && "SoA field out of range.");
+			return { m_Fields[field], m_Size };
+		}
+
+	private:
+
+		std::array<Float*, FIELD_COUNT> m_Fields;
+		std::size_t m_Size;
+	};
+
+	// -----------------------------------------
+	// SoA Scratch
+	// -----------------------------------------
+
+	/// Transposes AoS component arrays (archetype chunk columns) into
+	/// temporary field arrays and back, so column kernels also run on the
+	/// storage that keeps the component packed by value. Also gathers
+	/// scattered positions of SoA arrays, for arrays in different orders.
+
+	template<typename T>
+	class SoAScratch
+	{
+		using Component = std::remove_const_t<T>;
+		using Float = std::conditional_t<std::is_const_v<T>, const float, float>;
+		static constexpr std::size_t FIELD_COUNT = SoAColumns<T>::FIELD_COUNT;
+
+	public:
+
+		void Load(const Component* data, std::size_t count)
+		{
+			for (auto& field : m_Fields)
+				field.resize(count);
+
+			for (std::size_t i = 0; i < count; ++i)
+			{
+				float values[FIELD_COUNT];
+				std::memcpy(values, &data[i], sizeof(Component));
+
+				for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+					m_Fields[f][i] = values[f];
+			}
+		}
+
+		/** Writes the fields back, nothing to do for read-only columns */
+		void Store(T* data, std::size_t count) const
+		{
+			if constexpr (!std::is_const_v<T>)
+			{
+				for (std::size_t i = 0; i < count; ++i)
+				{
+					float values[FIELD_COUNT];
+
+					for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+						values[f] = m_Fields[f][i];
+
+					std::memcpy(&data[i], values, sizeof(Component));
+				}
+			}
+		}
+
+		/** Copies the components at the given packed positions of the array */
+		void Gather(const SoAComponentArray<Component>& array, std::span<const SparseIndex::Index> indices)
+		{
+			for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+			{
+				m_Fields[f].resize(indices.size());
+
+				for (std::size_t i = 0; i < indices.size(); ++i)
+					m_Fields[f][i] = array.GetFieldAt(f, indices[i]);
+			}
+		}
+
+		/** Writes the fields back to the positions they were gathered from */
+		void Scatter(SoAComponentArray<Component>& array, std::span<const SparseIndex::Index> indices) const
+		{
+			if constexpr (!std::is_const_v<T>)
+			{
+				for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+				{
+					for (std::size_t i = 0; i < indices.size(); ++i)
+						array.SetFieldAt(f, indices[i], m_Fields[f][i]);
+				}
+			}
+		}
+
+		SoAColumns<T> Columns(std::size_t offset = 0, std::size_t count = SIZE_MAX)
+		{
+			std::array<Float*, FIELD_COUNT> fields;
+			for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+				fields[f] = m_Fields[f].data() + offset;
+			return SoAColumns<T>(fields, std::min(count, m_Fields[0].size() - offset));
+		}
+
+	private:
+
+		// Line aligned like the SoA columns, so parallel kernels can split them the same way
+		std::array<std::vector<float, CacheAlignedAllocator<float>>, FIELD_COUNT> m_Fields{};
+	};
+
+	// -----------------------------------------
+	// SoA Component Array
+	// -----------------------------------------
+
+	/// SparseSet storage for ECS_SOA_COMPONENT types: same sparse index,
+	/// dense entity vector and change ticks as ComponentArray, but the
+	/// components are split into one float array per field.
+	/// Components are gathered into a T by value and scattered back.
+	/// The columns grow in pages like ComponentArray, so growing never
+	/// copies them and column pointers stay valid. The pages are cache
+	/// line aligned, for vector loads and so that parallel column kernels
+	/// can split them on line boundaries.
+
+	template<typename T>
+	class SoAComponentArray : public IComponentArray
+	{
+		static_assert(std::is_trivially_copyable_v<T> && sizeof(T) % sizeof(float) == 0 && alignof(T) == alignof(float),
+			"SoA components must be made of floats only.");
+
+	public:
+
+		static constexpr std::size_t FIELD_COUNT = sizeof(T) / sizeof(float);
+
+		void InsertData(Entity entity, const T& component, Tick tick);
+		void InsertData(std::span<const Entity> entities, std::span<const T> components, Tick tick);
+		void Reserve(std::size_t capacity);
+		void RemoveData(Entity entity);
+		void RemoveData(std::span<const Entity> entities);
+		void EntityDestroyed(Entity entity) override;
+		void CopyData(Entity entity, void* dst) override;
+		void InsertCopies(std::span<const Entity> entities, const void* component, Tick tick) override;
+
+		/** Gathered copy of the component at a packed position */
+		T GetDataAt(std::size_t index) const;
+		void SetDataAt(std::size_t index, const T& component);
+
+		/** One field of the component at a packed position */
+		float GetFieldAt(std::size_t field, std::size_t index) const { return m_Fields[field][index]; }
+		void SetFieldAt(std::size_t field, std::size_t index, float value) { m_Fields[field][index] = value; }
+
+		SparseIndex::Index GetIndex(Entity entity) const { return m_EntityToIndex.Get(entity); }
+		SparseIndex::Index Find(Entity entity) const { return m_EntityToIndex.Find(entity); }
+		bool Contains(Entity entity) const { return m_EntityToIndex.Contains(entity); }
+
+		std::size_t Size() const { return m_IndexToEntity.size(); }
+		const Entity* GetEntities() const { return m_IndexToEntity.data(); }
+
+		/// All the fields of the packed components from a packed position on,
+		/// up to count of them and never past the end of offset's page: call
+		/// again from offset plus the returned Size() for the rest.
+		SoAColumns<T> GetColumns(std::size_t offset = 0, std::size_t count = SIZE_MAX);
+		SoAColumns<const T> GetColumns(std::size_t offset = 0, std::size_t count = SIZE_MAX) const;
+
+		Tick GetChangeTick(std::size_t index) const { return m_ChangeTicks[index]; }
+		void SetChangeTick(std::size_t index, Tick tick) { m_ChangeTicks[index] = tick; }
+		void SetChangeTicks(std::size_t offset, std::size_t count, Tick tick)
+		{
+			for (std::size_t i = offset; i < offset + count; ++i)
+				m_ChangeTicks[i] = tick;
+		}
+
+		/** Swaps two packed positions, used to line up the order of several arrays (see OwningGroup) */
+		void SwapSlots(std::size_t a, std::size_t b);
+
+	private:
+
+		std::array<PagedArray<float, SOA_PAGE_SIZE>, FIELD_COUNT> m_Fields{};
+		PagedArray<Tick, SOA_PAGE_SIZE> m_ChangeTicks{};
+
+		SparseIndex m_EntityToIndex{};
+		std::vector<Entity> m_IndexToEntity{};
+
+		void RemoveAt(SparseIndex::Index index);
+
+		/** Elements of the run of the columns from offset to the end of its page */
+		std::size_t RunSize(std::size_t offset, std::size_t count) const
+		{
+			assert(offset < Size() && "SoA columns out of range.");
+			return std::min({ count, Size() - offset, SOA_PAGE_SIZE - offset % SOA_PAGE_SIZE });
+		}
+	};
+
+	/// Storage used by the ComponentManager for a component type
+	template<typename T>
+	using ComponentStorage = std::conditional_t<IsSoAComponent<T>, SoAComponentArray<T>, ComponentArray<T>>;
+
+	/// ----------------------------------------------
+	/// InsertData
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::InsertData(Entity entity, const T& component, Tick tick)
+	{
+		assert(!m_EntityToIndex.Contains(entity)
+			&& "Component added to same entity more than once.");
+
+		float values[FIELD_COUNT];
+		std::memcpy(values, &component, sizeof(T));
+
+		for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+			m_Fields[f].PushBack(values[f]);
+
+		m_EntityToIndex.Set(entity, static_cast<SparseIndex::Index>(m_IndexToEntity.size()));
+		m_IndexToEntity.push_back(entity);
+		m_ChangeTicks.PushBack(tick);
+	}
+
+	/// ----------------------------------------------
+	/// InsertData (batch)
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::InsertData(std::span<const Entity> entities, std::span<const T> components, Tick tick)
+	{
+		assert(entities.size() == components.size() && "One component per entity expected.");
+
+		Reserve(m_IndexToEntity.size() + entities.size());
+
+		for (std::size_t i = 0; i < entities.size(); ++i)
+			InsertData(entities[i], components[i], tick);
+	}
+
+	/// ----------------------------------------------
+	/// InsertCopies
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::InsertCopies(std::span<const Entity> entities, const void* component, Tick tick)
+	{
+		auto newIndex = static_cast<SparseIndex::Index>(m_IndexToEntity.size());
+
+		for (Entity entity : entities)
+		{
+			assert(!m_EntityToIndex.Contains(entity) && "Component added to same entity more than once.");
+			m_EntityToIndex.Set(entity, newIndex++);
+		}
+
+		float values[FIELD_COUNT];
+		std::memcpy(values, component, sizeof(T));
+
+		// Every field column gets one run of the same value
+		for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+			m_Fields[f].AppendCopies(entities.size(), values[f]);
+
+		m_IndexToEntity.insert(m_IndexToEntity.end(), entities.begin(), entities.end());
+		m_ChangeTicks.AppendCopies(entities.size(), tick);
+	}
+
+	/// ----------------------------------------------
+	/// Reserve
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::Reserve(std::size_t capacity)
+	{
+		for (auto& field : m_Fields)
+			field.Reserve(capacity);
+
+		m_IndexToEntity.reserve(capacity);
+		m_ChangeTicks.Reserve(capacity);
+	}
+
+	/// ----------------------------------------------
+	/// RemoveData
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::RemoveData(Entity entity)
+	{
+		assert(m_EntityToIndex.Contains(entity)
+			&& "Removing non-existent component.");
+
+		RemoveAt(m_EntityToIndex.Get(entity));
+	}
+
+	/// ----------------------------------------------
+	/// RemoveData (batch)
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::RemoveData(std::span<const Entity> entities)
+	{
+		std::vector<SparseIndex::Index> indices;
+		indices.reserve(entities.size());
+
+		for (Entity entity : entities)
+		{
+			assert(m_EntityToIndex.Contains(entity) && "Removing non-existent component.");
+			indices.push_back(m_EntityToIndex.Get(entity));
+		}
+
+		// Highest slots first, see ComponentArray::RemoveData
+		std::sort(indices.begin(), indices.end(), std::greater<>{});
+
+		for (auto index : indices)
+			RemoveAt(index);
+	}
+
+	/// ----------------------------------------------
+	/// RemoveAt
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::RemoveAt(SparseIndex::Index index)
+	{
+		const Entity entity = m_IndexToEntity[index];
+		const auto last = static_cast<SparseIndex::Index>(m_IndexToEntity.size() - 1);
+
+		// Move the last slot into the hole, field by field
+		if (index != last)
+		{
+			for (auto& field : m_Fields)
+				field[index] = field[last];
+
+			m_ChangeTicks[index] = m_ChangeTicks[last];
+			m_IndexToEntity[index] = m_IndexToEntity[last];
+			m_EntityToIndex.Set(m_IndexToEntity[index], index);
+			++m_LayoutVersion;
+		}
+
+		for (auto& field : m_Fields)
+			field.PopBack();
+
+		m_ChangeTicks.PopBack();
+		m_IndexToEntity.pop_back();
+		m_EntityToIndex.Erase(entity);
+	}
+
+	/// ----------------------------------------------
+	/// EntityDestroyed
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::EntityDestroyed(Entity entity)
+	{
+		if (m_EntityToIndex.Contains(entity))
+			RemoveData(entity);
+	}
+
+	/// ----------------------------------------------
+	/// CopyData
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::CopyData(Entity entity, void* dst)
+	{
+		assert(m_EntityToIndex.Contains(entity) && "Retrieving non-existent component.");
+
+		::new (dst) T(GetDataAt(m_EntityToIndex.Get(entity)));
+	}
+
+	/// ----------------------------------------------
+	/// GetDataAt
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline T SoAComponentArray<T>::GetDataAt(std::size_t index) const
+	{
+		float values[FIELD_COUNT];
+
+		for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+			values[f] = m_Fields[f][index];
+
+		T component;
+		std::memcpy(&component, values, sizeof(T));
+		return component;
+	}
+
+	/// ----------------------------------------------
+	/// SetDataAt
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::SetDataAt(std::size_t index, const T& component)
+	{
+		float values[FIELD_COUNT];
+		std::memcpy(values, &component, sizeof(T));
+
+		for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+			m_Fields[f][index] = values[f];
+	}
+
+	/// ----------------------------------------------
+	/// GetColumns
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline SoAColumns<T> SoAComponentArray<T>::GetColumns(std::size_t offset, std::size_t count)
+	{
+		const std::size_t run = RunSize(offset, count);
+
+		std::array<float*, FIELD_COUNT> fields;
+		for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+			fields[f] = &m_Fields[f][offset];
+
+		return SoAColumns<T>(fields, run);
+	}
+
+	template<typename T>
+	inline SoAColumns<const T> SoAComponentArray<T>::GetColumns(std::size_t offset, std::size_t count) const
+	{
+		const std::size_t run = RunSize(offset, count);
+
+		std::array<const float*, FIELD_COUNT> fields;
+		for (std::size_t f = 0; f < FIELD_COUNT; ++f)
+			fields[f] = &m_Fields[f][offset];
+
+		return SoAColumns<const T>(fields, run);
+	}
+
+	/// ----------------------------------------------
+	/// SwapSlots
+	/// ----------------------------------------------
+
+	template<typename T>
+	inline void SoAComponentArray<T>::SwapSlots(std::size_t a, std::size_t b)
+	{
+		for (auto& field : m_Fields)
+			std::swap(field[a], field[b]);
+
+		std::swap(m_ChangeTicks[a], m_ChangeTicks[b]);
+		std::swap(m_IndexToEntity[a], m_IndexToEntity[b]);
+		m_EntityToIndex.Set(m_IndexToEntity[a], static_cast<SparseIndex::Index>(a));
+		m_EntityToIndex.Set(m_IndexToEntity[b], static_cast<SparseIndex::Index>(b));
+		++m_LayoutVersion;
+	}
+}
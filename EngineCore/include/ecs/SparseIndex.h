@@ -0,0 +1,89 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include "ecs/Entity.h"
+
+namespace ecs {
+
+	/// Paged sparse index: maps an entity to a position in a dense array.
+	/// Keys are the entity index, the generation is ignored here.
+	///
+	/// The sparse side is split in fixed-size pages that are allocated only
+	/// when an entity falling in that range is first inserted, so a few
+	/// high entity IDs don't force a huge allocation. A lookup is just
+	/// two array accesses (page, then slot) instead of hashing into a map.
+
+	class SparseIndex
+	{
+	public:
+
+		using Index = std::uint32_t;
+
+		static constexpr Index INVALID_INDEX = UINT32_MAX;
+		static constexpr std::size_t PAGE_SIZE = 4096;
+
+		bool Contains(Entity entity) const
+		{
+			const std::uint32_t index = GetEntityIndex(entity);
+			const std::size_t page = index / PAGE_SIZE;
+			return page < m_Pages.size()
+				&& m_Pages[page]
+				&& m_Pages[page][index % PAGE_SIZE] != INVALID_INDEX;
+		}
+
+		/** Like Get() but returns INVALID_INDEX instead of asserting when missing */
+		Index Find(Entity entity) const
+		{
+			const std::uint32_t index = GetEntityIndex(entity);
+			const std::size_t page = index / PAGE_SIZE;
+			return page < m_Pages.size() && m_Pages[page]
+				? m_Pages[page][index % PAGE_SIZE]
+				: INVALID_INDEX;
+		}
+
+		Index Get(Entity entity) const
+		{
+			assert(Contains(entity) && "Entity not present in sparse index.");
+			const std::uint32_t index = GetEntityIndex(entity);
+			return m_Pages[index / PAGE_SIZE][index % PAGE_SIZE];
+		}
+
+		void Set(Entity entity, Index index)
+		{
+			const std::uint32_t entityIndex = GetEntityIndex(entity);
+			AssurePage(entityIndex / PAGE_SIZE)[entityIndex % PAGE_SIZE] = index;
+		}
+
+		void Erase(Entity entity)
+		{
+			assert(Contains(entity) && "Entity not present in sparse index.");
+			const std::uint32_t index = GetEntityIndex(entity);
+			m_Pages[index / PAGE_SIZE][index % PAGE_SIZE] = INVALID_INDEX;
+		}
+
+		void Clear() { m_Pages.clear(); }
+
+	private:
+
+		std::vector<std::unique_ptr<Index[]>> m_Pages{};
+
+		Index* AssurePage(std::size_t page)
+		{
+			if (page >= m_Pages.size())
+				m_Pages.resize(page + 1);
+
+			if (!m_Pages[page])
+			{
+				m_Pages[page] = std::make_unique<Index[]>(PAGE_SIZE);
+				std::fill_n(m_Pages[page].get(), PAGE_SIZE, INVALID_INDEX);
+			}
+
+			return m_Pages[page].get();
+		}
+	};
+}
@@ -1,16 +1,45 @@
 #pragma once
 #include "ecs/Entity.h"
-#include <set>
+#include "ecs/Component.h"
+#include "ecs/EntitySet.h"
+#include <cstdint>
 
 namespace ecs {
 
 	using SystemType = std::uint8_t;
 
+	// One past the largest system ID: every value of SystemType
+	constexpr std::uint32_t MAX_SYSTEMS = std::uint32_t(1) << (8 * sizeof(SystemType));
+
+	// -----------------------------------------
+	// Compile-time System Type IDs
+	// -----------------------------------------
+
+	/// Like components, every system type declares a fixed ID at global scope:
+	///
+	///		ECS_SYSTEM(ecs::MovementSystem, 0)
+
+	template<typename T>
+	struct SystemTraits;
+
+	template<typename T>
+	constexpr SystemType GetSystemTypeID()
+	{
+		return SystemTraits<T>::ID;
+	}
+
 	class System {
 		
 	public:
 
-		std::set<Entity> m_Entities;
+		// Dense, O(1) insert/erase membership list. It can be kept in
+		// component storage order with Coordinator::SortSystemEntities<T>()
+		// so iterating it also walks T's data linearly.
+		EntitySet m_Entities;
+
+		// Coordinator tick at the end of the last run, for
+		// systems that only process changed components
+		Tick m_LastRunTick = 0;
 
 		/*
 		// Usage example:
@@ -29,4 +58,12 @@ namespace ecs {
 
 
 	};
-}
\ No newline at end of file
+}
+
+#define ECS_SYSTEM(Type, Id) \
+	template<> \
+	struct ecs::SystemTraits<Type> \
+	{ \
+		static_assert(0 <= (Id) && (Id) < static_cast<long long>(ecs::MAX_SYSTEMS), "System ID out of range."); \
+		static constexpr ecs::SystemType ID = Id; \
+	};
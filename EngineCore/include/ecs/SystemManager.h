@@ -1,34 +1,27 @@
 #pragma once
 
 #include <memory>
-#include <bitset>
-#include <unordered_map>
+#include <array>
+#include <vector>
+#include <span>
+#include <algorithm>
 #include <cassert>
 #include "System.h"
 #include "Entity.h"
 #include "Component.h"
+#include "Signature.h"
 
 namespace ecs {
 
-	// -----------------------------------------
-	// Compile-time System Type IDs
-	// -----------------------------------------
-
-	inline SystemType GetNextSystemTypeID() {
-		static SystemType lastID = 0;
-		return lastID++;
-	}
-
-	template<typename T>
-	SystemType GetSystemTypeID() {
-		static SystemType typeID = GetNextSystemTypeID();
-		return typeID;
-	}
-
 	// -----------------------------------------
 	// System Manager
 	// -----------------------------------------
 
+	/// Systems and their signatures live in flat arrays indexed by SystemType.
+	/// On top of that, an inverted index maps every component bit to the
+	/// systems whose signature contains it, so adding or removing a single
+	/// component only re-evaluates the systems that care about it.
+
 	class SystemManager {
 
 	public:
@@ -38,48 +31,159 @@ namespace ecs {
 		{
 			SystemType type = ecs::GetSystemTypeID<T>();
 
-			assert(m_Systems.find(type) == m_Systems.end() 
-				&& "System already registered!");
+			if (IsRegistered(type))
+				DuplicateTypeID("System", type);
+
+			if (type >= m_Systems.size())
+			{
+				m_Systems.resize(type + 1);
+				m_Signatures.resize(type + 1);
+			}
 
 			auto system = std::make_shared<T>();
-			
-			m_Systems.insert({ type, system });
+
+			m_Systems[type] = system;
+			m_RegisteredTypes.push_back(type);
+
+			// No signature yet: interested in every entity, like an empty signature
+			m_UnfilteredSystems.push_back(type);
 
 			return system;
 		}
 
 		template<typename T>
-		void SetSignature(std::bitset<MAX_COMPONENTS> signature)
+		void SetSignature(const Signature& signature)
 		{
 			SystemType type = ecs::GetSystemTypeID<T>();
 
-			assert(m_Systems.find(type) != m_Systems.end() 
-				&& "System not registered!");
+			assert(IsRegistered(type) && "System not registered!");
 
+			UnindexSystem(type);
 			m_Signatures[type] = signature;
+			IndexSystem(type);
 		}
 
 		void EntityDestroyed(Entity entity)
 		{
-			for (auto const& [type, system] : m_Systems)
-				system->m_Entities.erase(entity);
+			for (SystemType type : m_RegisteredTypes)
+				m_Systems[type]->m_Entities.Erase(entity);
+		}
+
+		/// Full re-evaluation against every system,
+		/// for changes that touch more than one component at once.
+		void EntitySignatureChanged(Entity entity, const Signature& entitySignature)
+		{
+			for (SystemType type : m_RegisteredTypes)
+				UpdateMembership(type, entity, entitySignature);
 		}
 
-		void EntitySignatureChanged(Entity entity, std::bitset<MAX_COMPONENTS> entitySignature)
+		/// A component was added: only systems reading it can gain the entity.
+		void EntityComponentAdded(Entity entity, const Signature& entitySignature, ComponentType component)
 		{
-			for (auto const& [type, system] : m_Systems)
+			for (SystemType type : m_SystemsByComponent[component])
+			{
+				if (entitySignature.Contains(m_Signatures[type]))
+					m_Systems[type]->m_Entities.Insert(entity);
+			}
+
+			for (SystemType type : m_UnfilteredSystems)
+				m_Systems[type]->m_Entities.Insert(entity);
+		}
+
+		/// A component was removed: only systems reading it can lose the entity.
+		void EntityComponentRemoved(Entity entity, ComponentType component)
+		{
+			for (SystemType type : m_SystemsByComponent[component])
+				m_Systems[type]->m_Entities.Erase(entity);
+		}
+
+		/// Batched EntityComponentAdded: the systems that can gain entities are
+		/// gathered once for all the added components, then each of them checks
+		/// the whole batch. signatureOf(entity) returns the entity's final signature.
+		template<typename SignatureOf>
+		void EntitiesComponentsAdded(std::span<const Entity> entities, const Signature& added, SignatureOf&& signatureOf)
+		{
+			std::vector<SystemType> candidates = m_UnfilteredSystems;
+
+			for (std::size_t component = 0; component < MAX_COMPONENTS; ++component)
+			{
+				if (added.test(component))
+					candidates.insert(candidates.end(), m_SystemsByComponent[component].begin(), m_SystemsByComponent[component].end());
+			}
+
+			std::sort(candidates.begin(), candidates.end());
+			candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+			for (SystemType type : candidates)
 			{
-				auto const& systemSignature = m_Signatures[type];
+				const Signature& systemSignature = m_Signatures[type];
+				EntitySet& members = m_Systems[type]->m_Entities;
+
+				members.Reserve(members.Size() + entities.size());
 
-				if ((entitySignature & systemSignature) == systemSignature)
-					system->m_Entities.insert(entity);
-				else
-					system->m_Entities.erase(entity);
+				for (Entity entity : entities)
+				{
+					if (signatureOf(entity).Contains(systemSignature))
+						members.Insert(entity);
+				}
 			}
 		}
 
 	private:
-		std::unordered_map<SystemType, std::bitset<MAX_COMPONENTS>> m_Signatures{};
-		std::unordered_map<SystemType, std::shared_ptr<System>> m_Systems{};
+		// Indexed by SystemType, empty slots for types registered elsewhere
+		std::vector<Signature> m_Signatures{};
+		std::vector<std::shared_ptr<System>> m_Systems{};
+
+		// Dense list of the types registered here
+		std::vector<SystemType> m_RegisteredTypes{};
+
+		// Inverted index: component bit -> systems whose signature has it
+		std::array<std::vector<SystemType>, MAX_COMPONENTS> m_SystemsByComponent{};
+
+		// Systems with an empty signature match every entity
+		std::vector<SystemType> m_UnfilteredSystems{};
+
+		bool IsRegistered(SystemType type) const
+		{
+			return type < m_Systems.size() && m_Systems[type] != nullptr;
+		}
+
+		void UpdateMembership(SystemType type, Entity entity, const Signature& entitySignature)
+		{
+			if (entitySignature.Contains(m_Signatures[type]))
+				m_Systems[type]->m_Entities.Insert(entity);
+			else
+				m_Systems[type]->m_Entities.Erase(entity);
+		}
+
+		void IndexSystem(SystemType type)
+		{
+			const Signature& signature = m_Signatures[type];
+
+			if (signature.none())
+			{
+				m_UnfilteredSystems.push_back(type);
+				return;
+			}
+
+			for (std::size_t component = 0; component < MAX_COMPONENTS; ++component)
+			{
+				if (signature.test(component))
+					m_SystemsByComponent[component].push_back(type);
+			}
+		}
+
+		void UnindexSystem(SystemType type)
+		{
+			std::erase(m_UnfilteredSystems, type);
+
+			const Signature& signature = m_Signatures[type];
+
+			for (std::size_t component = 0; component < MAX_COMPONENTS; ++component)
+			{
+				if (signature.test(component))
+					std::erase(m_SystemsByComponent[component], type);
+			}
+		}
 	};
 }
\ No newline at end of file
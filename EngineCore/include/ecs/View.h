@@ -0,0 +1,313 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <utility>
+#include <cstddef>
+#include <type_traits>
+#include <cassert>
+#include "ecs/Entity.h"
+#include "ecs/Component.h"
+#include "ecs/SparseIndex.h"
+#include "ecs/ComponentArray.h"
+#include "ecs/SoAComponentArray.h"
+#include "ecs/Parallel.h"
+
+namespace ecs {
+
+	/// Multi-component query over the SparseSet storage.
+	///
+	/// The component arrays are resolved once when the view is built, then
+	/// iteration is driven by the smallest of them: for every entity in its
+	/// packed array the other components are fetched by direct index through
+	/// their sparse side, with no per-component lookup of the arrays.
+	///
+	/// Each(func) is the fast path: the loop is instantiated once per possible
+	/// lead array, so the lead component is read by position and the body
+	/// inlines into a plain loop. Range-for yields (Entity, Ts&...) tuples:
+	///
+	///		for (auto [entity, transform, velocity] : coordinator.View<Transform, Velocity>())
+	///
+	/// Use a const component type (View<const Transform>) for read-only access:
+	/// non-const components are stamped with the view's tick as they are
+	/// yielded, which is what EachChanged() relies on to skip the others.
+	/// SoA components (ECS_SOA_COMPONENT) must be const and are yielded by value.
+	///
+	/// When Ts are exactly the types of an owning group, the view is built
+	/// with the group size: the members are the first slots of every array,
+	/// in the same order, so Each() walks them in lockstep with no lookup.
+
+	template<typename... Ts>
+	class View
+	{
+		static_assert(sizeof...(Ts) > 0, "A View needs at least one component type.");
+		static_assert((!IsTagComponent<Ts> && ...), "Tag components can't be iterated, use them in a system signature.");
+		static_assert(((!IsSoAComponent<Ts> || std::is_const_v<Ts>) && ...), "SoA components are read-only in a View, write them with ForEachColumns.");
+
+		template<typename T>
+		using ArrayOf = ComponentStorage<std::remove_const_t<T>>;
+
+		// What the view yields for a component: a reference, or a copy for SoA ones
+		template<typename T>
+		using Ref = std::conditional_t<IsSoAComponent<T>, std::remove_const_t<T>, T&>;
+
+		using Index = SparseIndex::Index;
+
+	public:
+
+		class Iterator
+		{
+		public:
+
+			using value_type = std::tuple<Entity, Ref<Ts>...>;
+			using difference_type = std::ptrdiff_t;
+
+			Iterator(const View* view, std::size_t position)
+				: m_View(view), m_Position(position)
+			{
+				SkipMissing();
+			}
+
+			value_type operator*() const
+			{
+				const Entity entity = m_View->m_LeadEntities[m_Position];
+				return Dereference(entity, std::index_sequence_for<Ts...>{});
+			}
+
+			Iterator& operator++()
+			{
+				++m_Position;
+				SkipMissing();
+				return *this;
+			}
+
+			bool operator==(const Iterator& other) const { return m_Position == other.m_Position; }
+			bool operator!=(const Iterator& other) const { return m_Position != other.m_Position; }
+
+		private:
+
+			const View* m_View;
+			std::size_t m_Position;
+
+			void SkipMissing()
+			{
+				while (m_Position < m_View->m_LeadSize && !m_View->Matches(m_View->m_LeadEntities[m_Position]))
+					++m_Position;
+			}
+
+			template<std::size_t... Is>
+			value_type Dereference(Entity entity, std::index_sequence<Is...>) const
+			{
+				const std::array<Index, sizeof...(Ts)> indices{ std::get<Is>(m_View->m_Arrays)->GetIndex(entity)... };
+
+				(m_View->template Stamp<Is>(indices[Is]), ...);
+
+				return value_type{ entity, m_View->template Fetch<Is>(indices[Is])... };
+			}
+		};
+
+		explicit View(Tick tick, ArrayOf<Ts>*... arrays)
+			: m_Arrays(arrays...), m_Tick(tick)
+		{
+			// Pick the smallest array to drive the iteration
+			const std::array<std::size_t, sizeof...(Ts)> sizes{ arrays->Size()... };
+			const std::array<const Entity*, sizeof...(Ts)> entities{ arrays->GetEntities()... };
+
+			for (std::size_t i = 1; i < sizes.size(); ++i)
+			{
+				if (sizes[i] < sizes[m_LeadIndex])
+					m_LeadIndex = i;
+			}
+
+			m_LeadSize = sizes[m_LeadIndex];
+			m_LeadEntities = entities[m_LeadIndex];
+		}
+
+		/** View over the types of an owning group, whose first groupSize slots line up */
+		View(Tick tick, std::size_t groupSize, ArrayOf<Ts>*... arrays)
+			: m_Arrays(arrays...), m_Tick(tick), m_Grouped(true)
+		{
+			m_LeadSize = groupSize;
+			m_LeadEntities = std::get<0>(m_Arrays)->GetEntities();
+		}
+
+		Iterator begin() const { return Iterator(this, 0); }
+		Iterator end() const { return Iterator(this, m_LeadSize); }
+
+		/** Upper bound of the entities the view yields (size of the lead array) */
+		std::size_t SizeHint() const { return m_LeadSize; }
+
+		/** Calls func(entity, Ts&...) for every entity that has all the components */
+		template<typename Func>
+		void Each(Func&& func) const
+		{
+			EachDispatch(func, std::index_sequence_for<Ts...>{}, 0, m_LeadSize);
+		}
+
+		/// Each() split over the job system: func runs concurrently, on ranges
+		/// cut on cache lines of every array the jobs write, so no two jobs
+		/// ever write to the same line. A group walks all its arrays at the
+		/// same positions and is cut on lines of all of them. Otherwise the
+		/// other arrays are reached through their sparse index, in any order,
+		/// so only one component may be written: it drives the walk, whatever
+		/// its size. Writing several needs an owning group over Ts.
+		template<typename Func>
+		void ParallelEach(core::JobSystem& jobs, Func&& func) const
+		{
+			if (m_Grouped)
+			{
+				constexpr std::size_t alignment = ElementsPerCacheLine<Tick, std::remove_const_t<Ts>...>();
+
+				ParallelForAligned(jobs, m_LeadSize, alignment, [this, &func](std::size_t begin, std::size_t end) {
+					EachGrouped<false>(func, std::index_sequence_for<Ts...>{}, 0, begin, end);
+				});
+			}
+			else if constexpr (WRITTEN_COUNT == 0)
+			{
+				ParallelForAligned(jobs, m_LeadSize, 1, [this, &func](std::size_t begin, std::size_t end) {
+					EachDispatch(func, std::index_sequence_for<Ts...>{}, begin, end);
+				});
+			}
+			else if constexpr (WRITTEN_COUNT == 1)
+			{
+				constexpr std::size_t written = WrittenIndex();
+				constexpr std::size_t alignment = ElementsPerCacheLine<Tick, std::remove_const_t<std::tuple_element_t<written, std::tuple<Ts...>>>>();
+
+				ParallelForAligned(jobs, std::get<written>(m_Arrays)->Size(), alignment, [this, &func](std::size_t begin, std::size_t end) {
+					EachLead<written, false>(func, std::index_sequence_for<Ts...>{}, 0, begin, end);
+				});
+			}
+			else
+			{
+				// Cutting on one array's lines would leave the others shared
+				assert(false && "ParallelEach writing several components needs an owning group over them.");
+				Each(func);
+			}
+		}
+
+		/// Like Each() but only for the entities whose first component was
+		/// modified after the since tick. The first array drives the loop
+		/// here, whatever its size, since the filter is on its change ticks.
+		template<typename Func>
+		void EachChanged(Tick since, Func&& func) const
+		{
+			if (m_Grouped)
+				EachGrouped<true>(func, std::index_sequence_for<Ts...>{}, since, 0, m_LeadSize);
+			else
+				EachLead<0, true>(func, std::index_sequence_for<Ts...>{}, since, 0, std::get<0>(m_Arrays)->Size());
+		}
+
+	private:
+
+		static constexpr std::size_t WRITTEN_COUNT = (std::size_t(!std::is_const_v<Ts>) + ...);
+
+		/** Position of the first non-const component in Ts */
+		static constexpr std::size_t WrittenIndex()
+		{
+			constexpr std::array<bool, sizeof...(Ts)> written{ !std::is_const_v<Ts>... };
+
+			for (std::size_t i = 0; i < written.size(); ++i)
+			{
+				if (written[i])
+					return i;
+			}
+
+			return 0;
+		}
+
+		std::tuple<ArrayOf<Ts>*...> m_Arrays;
+		Tick m_Tick = 0;
+		std::size_t m_LeadIndex = 0;
+		std::size_t m_LeadSize = 0;
+		const Entity* m_LeadEntities = nullptr;
+		bool m_Grouped = false;
+
+		bool Matches(Entity entity) const
+		{
+			if (m_Grouped)
+				return true;
+
+			return std::apply([entity](auto*... arrays) { return (arrays->Contains(entity) && ...); }, m_Arrays);
+		}
+
+		template<typename Func, std::size_t... Is>
+		void EachDispatch(Func& func, std::index_sequence<Is...> sequence, std::size_t begin, std::size_t end) const
+		{
+			if (m_Grouped)
+			{
+				EachGrouped<false>(func, sequence, 0, begin, end);
+				return;
+			}
+
+			// Branch once on the lead array, not per entity
+			((m_LeadIndex == Is ? (EachLead<Is, false>(func, sequence, 0, begin, end), true) : false) || ...);
+		}
+
+		/** Walks the positions [begin, end) of the Lead-th array */
+		template<std::size_t Lead, bool Changed, typename Func, std::size_t... Is>
+		void EachLead(Func& func, std::index_sequence<Is...>, Tick since, std::size_t begin, std::size_t end) const
+		{
+			auto* lead = std::get<Lead>(m_Arrays);
+			const Entity* entities = lead->GetEntities();
+
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				if constexpr (Changed)
+				{
+					if (lead->GetChangeTick(i) <= since)
+						continue;
+				}
+
+				const Entity entity = entities[i];
+				std::array<Index, sizeof...(Ts)> indices{};
+
+				const bool match = ((Is == Lead
+					? (indices[Is] = static_cast<Index>(i), true)
+					: (indices[Is] = std::get<Is>(m_Arrays)->Find(entity)) != SparseIndex::INVALID_INDEX) && ...);
+
+				if (match)
+				{
+					(Stamp<Is>(indices[Is]), ...);
+					func(entity, Fetch<Is>(indices[Is])...);
+				}
+			}
+		}
+
+		/** Lockstep walk over the group members, the same slot in every array */
+		template<bool Changed, typename Func, std::size_t... Is>
+		void EachGrouped(Func& func, std::index_sequence<Is...>, Tick since, std::size_t begin, std::size_t end) const
+		{
+			auto* first = std::get<0>(m_Arrays);
+
+			for (std::size_t i = begin; i < end; ++i)
+			{
+				if constexpr (Changed)
+				{
+					if (first->GetChangeTick(i) <= since)
+						continue;
+				}
+
+				const Index index = static_cast<Index>(i);
+
+				(Stamp<Is>(index), ...);
+				func(m_LeadEntities[i], Fetch<Is>(index)...);
+			}
+		}
+
+		template<std::size_t I>
+		Ref<std::tuple_element_t<I, std::tuple<Ts...>>> Fetch(Index index) const
+		{
+			return std::get<I>(m_Arrays)->GetDataAt(index);
+		}
+
+		/** Marks the I-th component at a packed position as modified, unless it's read-only */
+		template<std::size_t I>
+		void Stamp(Index index) const
+		{
+			using T = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+			if constexpr (!std::is_const_v<T>)
+				std::get<I>(m_Arrays)->SetChangeTick(index, m_Tick);
+		}
+	};
+}
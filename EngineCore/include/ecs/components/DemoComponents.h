@@ -1,5 +1,6 @@
 #pragma once
 #include "IMesh.h"
+#include "ecs/Component.h"
 #include <DirectXMath.h>
 
 namespace ecs {
@@ -23,4 +24,20 @@ namespace ecs {
 		std::shared_ptr<gfx::IMesh> mesh;
 	};
 
-}
\ No newline at end of file
+	// World matrix built from the Transform, only rebuilt when it changes.
+	// previous is the matrix of the step before, to interpolate between the two
+	struct WorldMatrix {
+		DirectX::XMFLOAT4X4 value{};
+		DirectX::XMFLOAT4X4 previous{};
+		bool placed = false;    // false until the first build, previous is meaningless
+	};
+
+}
+
+// Stable component IDs, never reuse or renumber them.
+// Transform and Velocity are stored column-wise for the movement kernel.
+ECS_SOA_COMPONENT(ecs::Transform, 0)
+ECS_SOA_COMPONENT(ecs::Velocity, 1)
+ECS_COMPONENT(ecs::Color, 2)
+ECS_COMPONENT(ecs::MeshComponent, 3)
+ECS_COMPONENT(ecs::WorldMatrix, 4)
\ No newline at end of file
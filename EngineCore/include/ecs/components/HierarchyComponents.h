@@ -0,0 +1,34 @@
+#pragma once
+#include <vector>
+#include "Transform.h"
+#include "ecs/Entity.h"
+#include "ecs/Component.h"
+
+namespace ecs {
+
+	// The entity this one is attached to (set with HierarchySystem::SetParent)
+	struct Parent {
+		Entity entity = NULL_ENTITY;
+	};
+
+	// Direct children, kept in sync with their Parent by the HierarchySystem
+	struct Children {
+		std::vector<Entity> entities;
+	};
+
+	// Transform relative to the parent, or to the world for a root
+	struct LocalTransform {
+		adg::Transform value{ adg::Vector3(), adg::Quaternion::identity(), adg::Scalar(1) };
+	};
+
+	// LocalTransform cumulated with every ancestor's, written by the HierarchySystem
+	struct WorldTransform {
+		adg::Transform value{ adg::Vector3(), adg::Quaternion::identity(), adg::Scalar(1) };
+	};
+
+}
+
+ECS_COMPONENT(ecs::Parent, 5)
+ECS_COMPONENT(ecs::Children, 6)
+ECS_COMPONENT(ecs::LocalTransform, 7)
+ECS_COMPONENT(ecs::WorldTransform, 8)
@@ -1,7 +1,10 @@
 #pragma once
 #include "ecs/System.h"
 #include "ecs/Coordinator.h"
+#include "ecs/Scheduler.h"
+#include "core/DoubleBuffer.h"
 #include "ecs/Components/DemoComponents.h"
+#include "ecs/components/HierarchyComponents.h"
 #include <DirectXMath.h>
 #include "IRenderer.h"
 #include "IShaderClass.h"
@@ -10,21 +13,63 @@ namespace ecs {
 
 	class MovementSystem : public System {
 	public:
-		void Update(Coordinator& coordinator, float dt) {
-			
-			for (auto entity : m_Entities) {
-				auto& transform = coordinator.GetComponent<Transform>(entity);
-				auto& velocity = coordinator.GetComponent<Velocity>(entity);
 
-				transform.rotation.y += velocity.angularSpeed * dt;
+		static constexpr SystemAccess ACCESS = SystemAccess::Of<Transform, const Velocity>();
 
-				// Circolar position
-				transform.position.x = cosf(transform.rotation.y) * velocity.radius;
-				transform.position.z = sinf(transform.rotation.y) * velocity.radius;
-			}
+		void Update(Coordinator& coordinator, core::JobSystem& jobs, float dt) {
+			
+			// Each job gets a range of the columns cut on cache lines, the kernel doesn't change
+			coordinator.ParallelForEachColumns<Transform, const Velocity>(jobs, [dt](std::size_t count, SoAColumns<Transform> transform, SoAColumns<const Velocity> velocity) {
+
+				const std::span<float> rotationY = transform.Field(ECS_SOA_FIELD(Transform, rotation.y));
+				const std::span<float> positionX = transform.Field(ECS_SOA_FIELD(Transform, position.x));
+				const std::span<float> positionZ = transform.Field(ECS_SOA_FIELD(Transform, position.z));
+				const std::span<const float> angularSpeed = velocity.Field(ECS_SOA_FIELD(Velocity, angularSpeed));
+				const std::span<const float> radius = velocity.Field(ECS_SOA_FIELD(Velocity, radius));
+
+				// 4 entities per iteration, sin/cos included
+				const DirectX::XMVECTOR step = DirectX::XMVectorReplicate(dt);
+				std::size_t i = 0;
+
+				for (; i + 4 <= count; i += 4)
+				{
+					DirectX::XMVECTOR angle = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&rotationY[i]));
+					angle = DirectX::XMVectorMultiplyAdd(DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&angularSpeed[i])), step, angle);
+
+					DirectX::XMVECTOR sin, cos;
+					DirectX::XMVectorSinCos(&sin, &cos, angle);
+
+					// Circolar position
+					const DirectX::XMVECTOR r = DirectX::XMLoadFloat4(reinterpret_cast<const DirectX::XMFLOAT4*>(&radius[i]));
+					DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&rotationY[i]), angle);
+					DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&positionX[i]), DirectX::XMVectorMultiply(cos, r));
+					DirectX::XMStoreFloat4(reinterpret_cast<DirectX::XMFLOAT4*>(&positionZ[i]), DirectX::XMVectorMultiply(sin, r));
+				}
+
+				for (; i < count; ++i)
+				{
+					rotationY[i] += angularSpeed[i] * dt;
+					positionX[i] = cosf(rotationY[i]) * radius[i];
+					positionZ[i] = sinf(rotationY[i]) * radius[i];
+				}
+			});
 		}
 	};
 
+	/// What the render thread draws for one entity, copied out of the ECS.
+	/// The mesh is borrowed: it must outlive the frames in flight.
+	struct RenderPacket {
+		DirectX::XMFLOAT4X4 world;
+		DirectX::XMFLOAT4X4 previous;   // world at the step before, see Draw
+		DirectX::XMFLOAT4 color;
+		gfx::IMesh* mesh;
+	};
+
+	/// Split in two stages so that drawing overlaps the next simulation:
+	/// Extract() runs on the main thread and fills the back packet array,
+	/// SwapPackets() hands it over, Draw() submits it on the render thread
+	/// without touching the ECS.
+	/// Draws its members: give it the signature WorldMatrix, Color, MeshComponent.
 	class RenderSystem : public System {
 	public:
 
@@ -35,38 +80,67 @@ namespace ecs {
 		{
 			m_Renderer = renderer;
 			m_Shader = shader;
-			m_View = view;
-			m_Projection = projection;
+			XMStoreFloat4x4(&m_View, view);
+			XMStoreFloat4x4(&m_Projection, projection);
 		}
 
-		void Update(Coordinator& coordinator)
+		/// Call before each fixed step, outside the Scheduler: the matrices
+		/// are brought up to the last step and kept as the previous ones, so
+		/// Draw always blends the last two steps however many run per frame.
+		void BeginStep(Coordinator& coordinator)
 		{
-			m_Renderer->BeginFrame(0.1f, 0.1f, 0.15f, 1.0f);
+			UpdateMatrices(coordinator);
 
-			for (auto entity : m_Entities) {
-				auto& transform = coordinator.GetComponent<Transform>(entity);
-				auto& color = coordinator.GetComponent<Color>(entity);
-				auto& meshRef = coordinator.GetComponent<MeshComponent>(entity);
+			coordinator.ForEach<WorldMatrix>([](Entity, WorldMatrix& world) {
+				world.previous = world.value;
+			});
+		}
 
-				DirectX::XMMATRIX world =
-					DirectX::XMMatrixScaling(transform.scale.x, transform.scale.y, transform.scale.z) *
-					DirectX::XMMatrixRotationRollPitchYaw(transform.rotation.x, transform.rotation.y, transform.rotation.z) *
-					DirectX::XMMatrixTranslation(transform.position.x, transform.position.y, transform.position.z);
+		/** Once per frame after the steps, fills the back packet array */
+		void Extract(Coordinator& coordinator)
+		{
+			UpdateMatrices(coordinator);
+
+			// The render thread may still be reading the front array
+			std::vector<RenderPacket>& packets = m_Packets.Back();
+			packets.clear();
 
-				DirectX::XMFLOAT4X4 world4x4, view4x4, proj4x4;
-				XMStoreFloat4x4(&world4x4, world);
-				XMStoreFloat4x4(&view4x4, m_View);
-				XMStoreFloat4x4(&proj4x4, m_Projection);
+			// The members, in WorldMatrix order: the biggest of the three is read linearly
+			coordinator.SortSystemEntities<WorldMatrix>(*this);
+			packets.reserve(m_Entities.Size());
 
-				m_Shader->SetMatrices(reinterpret_cast<float*>(&world4x4),
-					reinterpret_cast<float*>(&view4x4),
-					reinterpret_cast<float*>(&proj4x4));
+			for (Entity entity : m_Entities)
+			{
+				const WorldMatrix& world = coordinator.GetComponent<const WorldMatrix>(entity);
 
-				m_Shader->SetColor(reinterpret_cast<const float*>(&color.value));
+				packets.push_back({ world.value, world.previous,
+					coordinator.GetComponent<const Color>(entity).value,
+					coordinator.GetComponent<const MeshComponent>(entity).mesh.get() });
+			}
+		}
+
+		/** Call when the render thread is idle */
+		void SwapPackets() { m_Packets.Swap(); }
+
+		/// alpha: where the frame falls between the previous step and the
+		/// last one, the packets are drawn blended by it (1 = last step)
+		void Draw(float alpha)
+		{
+			m_Renderer->BeginFrame(0.1f, 0.1f, 0.15f, 1.0f);
+
+			for (const RenderPacket& packet : m_Packets.Front())
+			{
+				const DirectX::XMFLOAT4X4 world = Interpolate(packet.previous, packet.world, alpha);
+
+				m_Shader->SetMatrices(reinterpret_cast<const float*>(&world),
+					reinterpret_cast<const float*>(&m_View),
+					reinterpret_cast<const float*>(&m_Projection));
+
+				m_Shader->SetColor(reinterpret_cast<const float*>(&packet.color));
 				m_Shader->Bind();
 
-				meshRef.mesh->LoadBuffersOnGPU();
-				m_Renderer->Draw(meshRef.mesh->GetIndexCount());
+				packet.mesh->LoadBuffersOnGPU();
+				m_Renderer->Draw(packet.mesh->GetIndexCount());
 			}
 
 			m_Renderer->PresentFrame();
@@ -74,10 +148,79 @@ namespace ecs {
 
 	private:
 
+		/** Rebuilds the world matrices only where the Transform changed since the last call */
+		void UpdateMatrices(Coordinator& coordinator)
+		{
+			coordinator.ForEachChanged<const Transform, WorldMatrix>(m_LastRunTick, [](Entity, const Transform& transform, WorldMatrix& world) {
+
+				DirectX::XMMATRIX matrix =
+					DirectX::XMMatrixScaling(transform.scale.x, transform.scale.y, transform.scale.z) *
+					DirectX::XMMatrixRotationRollPitchYaw(transform.rotation.x, transform.rotation.y, transform.rotation.z) *
+					DirectX::XMMatrixTranslation(transform.position.x, transform.position.y, transform.position.z);
+
+				Place(world, matrix);
+			});
+
+			// Same for the entities placed by the HierarchySystem
+			coordinator.ForEachChanged<const WorldTransform, WorldMatrix>(m_LastRunTick, [](Entity, const WorldTransform& transform, WorldMatrix& world) {
+
+				const adg::Transform& t = transform.value;
+
+				DirectX::XMMATRIX matrix =
+					DirectX::XMMatrixScaling(t.scale, t.scale, t.scale) *
+					DirectX::XMMatrixRotationQuaternion(DirectX::XMVectorSet(t.rotation.im.x, t.rotation.im.y, t.rotation.im.z, t.rotation.w)) *
+					DirectX::XMMatrixTranslation(t.translation.x, t.translation.y, t.translation.z);
+
+				Place(world, matrix);
+			});
+
+			m_LastRunTick = coordinator.GetTick();
+		}
+
+		static void Place(WorldMatrix& world, DirectX::FXMMATRIX matrix)
+		{
+			XMStoreFloat4x4(&world.value, matrix);
+
+			// Nothing to come from on the first build
+			if (!world.placed)
+			{
+				world.previous = world.value;
+				world.placed = true;
+			}
+		}
+
+		/** Blends scale, rotation and translation apart, a plain lerp of the matrices would shear the rotation */
+		static DirectX::XMFLOAT4X4 Interpolate(const DirectX::XMFLOAT4X4& from, const DirectX::XMFLOAT4X4& to, float alpha)
+		{
+			if (alpha >= 1.0f)
+				return to;
+
+			DirectX::XMVECTOR scaleFrom, rotationFrom, translationFrom;
+			DirectX::XMVECTOR scaleTo, rotationTo, translationTo;
+
+			if (!DirectX::XMMatrixDecompose(&scaleFrom, &rotationFrom, &translationFrom, XMLoadFloat4x4(&from)) ||
+				!DirectX::XMMatrixDecompose(&scaleTo, &rotationTo, &translationTo, XMLoadFloat4x4(&to)))
+				return to;
+
+			DirectX::XMFLOAT4X4 result;
+			XMStoreFloat4x4(&result, DirectX::XMMatrixAffineTransformation(
+				DirectX::XMVectorLerp(scaleFrom, scaleTo, alpha),
+				DirectX::XMVectorZero(),
+				DirectX::XMQuaternionSlerp(rotationFrom, rotationTo, alpha),
+				DirectX::XMVectorLerp(translationFrom, translationTo, alpha)));
+
+			return result;
+		}
+
 		gfx::IRenderer* m_Renderer{};
 		gfx::IShaderClass* m_Shader{};
-		DirectX::XMMATRIX m_View;
-		DirectX::XMMATRIX m_Projection;
+		DirectX::XMFLOAT4X4 m_View{};
+		DirectX::XMFLOAT4X4 m_Projection{};
+
+		core::DoubleBuffer<std::vector<RenderPacket>> m_Packets{};
 	};
 
-}
\ No newline at end of file
+}
+
+ECS_SYSTEM(ecs::MovementSystem, 0)
+ECS_SYSTEM(ecs::RenderSystem, 1)
\ No newline at end of file
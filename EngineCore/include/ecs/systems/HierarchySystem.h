@@ -0,0 +1,77 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include "ecs/System.h"
+#include "ecs/SparseIndex.h"
+#include "ecs/Coordinator.h"
+#include "ecs/Scheduler.h"
+#include "ecs/components/HierarchyComponents.h"
+
+namespace ecs {
+
+	// -----------------------------------------
+	// Hierarchy System
+	// -----------------------------------------
+
+	/// Parent/child relationships between entities with a LocalTransform
+	/// and a WorldTransform. A child's world transform is its local one
+	/// cumulated with its parent's world (adg::Transform::cumulate_with).
+	///
+	/// The members are kept sorted breadth-first, so every parent comes
+	/// before its children and Update() is one linear pass that reads the
+	/// parent's world from an earlier slot. With the SparseSet backend the
+	/// LocalTransform and WorldTransform arrays are arranged in that same
+	/// order, and arranged again when something else moved them (a
+	/// swap-remove, see Coordinator::GetLayoutVersion). Subtrees whose
+	/// local transforms didn't change since the last run are skipped.
+	///
+	/// Always change the relationships through SetParent / RemoveParent /
+	/// DestroyHierarchy, which keep Parent and Children in sync.
+
+	class HierarchySystem : public System {
+	public:
+
+		// Arranging the storage in hierarchy order counts as a write of the local transforms
+		static constexpr SystemAccess ACCESS = SystemAccess::Of<LocalTransform, WorldTransform, const Parent, const Children>();
+
+		/** Attaches child to parent, its LocalTransform becomes relative to the parent */
+		void SetParent(Coordinator& coordinator, Entity child, Entity parent);
+
+		/** Detaches the entity, it becomes a root */
+		void RemoveParent(Coordinator& coordinator, Entity child);
+
+		/** Destroys the entity and all its descendants */
+		void DestroyHierarchy(Coordinator& coordinator, Entity root);
+
+		/** Propagates the changed local transforms down to the world transforms */
+		void Update(Coordinator& coordinator);
+
+	private:
+
+		static constexpr std::uint32_t NO_PARENT = UINT32_MAX;
+
+		// Breadth-first order of the members, and the slot of each one's parent
+		std::vector<Entity> m_Order{};
+		std::vector<std::uint32_t> m_ParentSlots{};
+		SparseIndex m_Slots{};
+
+		// World transforms in the same order, read back by the children
+		std::vector<adg::Transform> m_WorldTransforms{};
+		std::vector<std::uint8_t> m_Dirty{};
+
+		// Set by the relationship changes, which don't touch the membership
+		bool m_HierarchyChanged = false;
+
+		// Layout versions of the transform arrays once arranged in m_Order
+		std::uint32_t m_LocalLayout = 0;
+		std::uint32_t m_WorldLayout = 0;
+
+		void Rebuild(Coordinator& coordinator);
+		void Arrange(Coordinator& coordinator);
+		void PushSlot(Entity entity, std::uint32_t parentSlot);
+		bool IsAncestor(Coordinator& coordinator, Entity ancestor, Entity entity) const;
+	};
+
+}
+
+ECS_SYSTEM(ecs::HierarchySystem, 2)
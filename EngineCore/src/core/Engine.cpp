@@ -3,6 +3,7 @@
 #include "core/events/WindowEvent.h"
 #include "core/InputSystem.h"
 #include "core/Key_Defines.h"
+#include <cmath>
 #include <cassert>
 
 /// ----------------------------------------------------------------
@@ -39,6 +40,10 @@ core::Engine::Engine() {
 	// Create Timer
 	// Initialize
 	m_Timer = ITimer::Create();
+
+	// Workers start now and stay around, layers use them from OnAttach on.
+	// The render thread (see Start) keeps a hardware thread for itself
+	m_JobSystem = std::make_unique<JobSystem>(JobSystem::DefaultWorkerCount(1));
 }
 
 /// ----------------------------------------------------------------
@@ -57,7 +62,18 @@ core::Engine::~Engine() {
 void core::Engine::Start() {
 
 	m_Running = true;
+
+	// The layers are attached: from now on their OnRender runs on its own thread
+	m_RenderThread = std::make_unique<RenderThread>([this](float alpha) {
+		for (auto& layer : m_LayerStack)
+			layer->OnRender(alpha);
+	});
+
 	Run();
+
+	// Let the last frame finish before the layers go away, its Present may need the window
+	m_RenderThread->Wait([this] { m_Window->PollEvents(); });
+	m_RenderThread.reset();
 }
 
 /// ----------------------------------------------------------------
@@ -112,26 +128,84 @@ void core::Engine::Run() {
 		// Update Timer
 		m_Timer->Tick();
 
-		// Update Layers
+		// Update Layers, while the render thread draws the previous frame
+		const float alpha = Update(m_Timer->GetDeltaTime());
+
+		// Copy out what this frame draws, still overlapping the previous draw
 		for (auto& layer : m_LayerStack)
 		{
-			layer->OnUpdate(m_Timer->GetDeltaTime());
+			layer->OnExtract();
 		}
 
-		// Render Layers
-		for (auto& layer : m_LayerStack)  // if no modification, use const
+		// The previous frame is drawn: hand this one over and render it.
+		// Keep handling the window's messages meanwhile, the draw's Present may wait for them
+		m_RenderThread->Wait([this] { m_Window->PollEvents(); });
+
+		for (auto& layer : m_LayerStack)
 		{
-			layer->OnRender();
+			layer->OnRenderSync();
 		}
+
+		m_RenderThread->Kick(alpha);
 	}
 }
 
+/// ----------------------------------------------------------------
+/// Engine::Update
+/// ----------------------------------------------------------------
+
+float core::Engine::Update(float frameTime) {
+
+	if (m_Timestep.mode == TimestepMode::Variable)
+	{
+		for (auto& layer : m_LayerStack)
+			layer->OnUpdate(frameTime);
+
+		return 1.0f;
+	}
+
+	const double step = m_Timestep.fixedDeltaTime;
+	m_Accumulator += frameTime;
+
+	uint32_t steps = 0;
+	while (m_Accumulator >= step && steps < m_Timestep.maxStepsPerFrame)
+	{
+		for (auto& layer : m_LayerStack)
+			layer->OnUpdate(m_Timestep.fixedDeltaTime);
+
+		m_Accumulator -= step;
+		++steps;
+	}
+
+	// Too far behind: let the simulation run slower than real time
+	// rather than owe it more steps every frame
+	if (m_Accumulator >= step)
+		m_Accumulator = std::fmod(m_Accumulator, step);
+
+	return static_cast<float>(m_Accumulator / step);
+}
+
+/// ----------------------------------------------------------------
+/// Engine::SetTimestep
+/// ----------------------------------------------------------------
+
+void core::Engine::SetTimestep(const TimestepSpecs& specs) {
+
+	assert(specs.fixedDeltaTime > 0.0f && specs.maxStepsPerFrame > 0 && "Invalid fixed timestep.");
+
+	m_Timestep = specs;
+	m_Accumulator = 0.0;
+}
+
 /// ----------------------------------------------------------------
 /// Engine::Shutdown
 /// ----------------------------------------------------------------
 
 void core::Engine::Shutdown()
 {
+	// Normally stopped at the end of Start() already
+	m_RenderThread.reset();
+
 	// Since I'm using unique_ptr I don't need to manually delete stuff
 	// Also Win32Window releases its resources in its dtor
 	// Probably also the Renderer
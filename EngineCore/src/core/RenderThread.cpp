@@ -0,0 +1,95 @@
+#include "core/RenderThread.h"
+#include <cassert>
+
+/// ----------------------------------------------------------------
+/// RenderThread Ctor
+/// ----------------------------------------------------------------
+
+core::RenderThread::RenderThread(RenderFunction render)
+	: m_Render(std::move(render)), m_Thread(&RenderThread::Loop, this)
+{
+	assert(m_Render && "RenderThread without a render function.");
+}
+
+/// ----------------------------------------------------------------
+/// RenderThread Dtor
+/// ----------------------------------------------------------------
+
+core::RenderThread::~RenderThread()
+{
+	Wait();
+
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+		m_Exit = true;
+	}
+	m_Kicked.notify_one();
+
+	m_Thread.join();
+}
+
+/// ----------------------------------------------------------------
+/// RenderThread::Kick
+/// ----------------------------------------------------------------
+
+void core::RenderThread::Kick(float alpha)
+{
+	{
+		std::lock_guard<std::mutex> lock(m_Mutex);
+
+		assert(!m_Pending && "Kicking a frame while the previous one is still drawn.");
+
+		m_Alpha = alpha;
+		m_Pending = true;
+	}
+	m_Kicked.notify_one();
+}
+
+/// ----------------------------------------------------------------
+/// RenderThread::Wait
+/// ----------------------------------------------------------------
+
+void core::RenderThread::Wait(const PumpFunction& pump)
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	if (!pump)
+	{
+		m_Drawn.wait(lock, [this] { return !m_Pending; });
+		return;
+	}
+
+	// Still woken at once when the frame is drawn, the interval only bounds the pump's latency
+	while (!m_Drawn.wait_for(lock, PUMP_INTERVAL, [this] { return !m_Pending; }))
+	{
+		lock.unlock();
+		pump();
+		lock.lock();
+	}
+}
+
+/// ----------------------------------------------------------------
+/// RenderThread::Loop
+/// ----------------------------------------------------------------
+
+void core::RenderThread::Loop()
+{
+	std::unique_lock<std::mutex> lock(m_Mutex);
+
+	while (true)
+	{
+		m_Kicked.wait(lock, [this] { return m_Pending || m_Exit; });
+
+		if (m_Exit)
+			return;
+
+		// Draw without the lock, the main thread only waits on m_Pending
+		const float alpha = m_Alpha;
+		lock.unlock();
+		m_Render(alpha);
+		lock.lock();
+
+		m_Pending = false;
+		m_Drawn.notify_one();
+	}
+}
@@ -0,0 +1,184 @@
+#include "core/jobs/JobSystem.h"
+#include <cassert>
+
+namespace {
+
+	// Which JobSystem the calling thread works for, and its deque there
+	thread_local const core::JobSystem* t_JobSystem = nullptr;
+	thread_local std::uint32_t t_QueueIndex = 0;
+}
+
+/// ----------------------------------------------------------------
+/// JobSystem Ctor
+/// ----------------------------------------------------------------
+
+core::JobSystem::JobSystem(std::uint32_t workerCount, std::chrono::microseconds spinTime)
+	: m_SpinTime(spinTime)
+{
+	for (std::uint32_t i = 0; i <= workerCount; ++i)
+		m_Queues.push_back(std::make_unique<WorkStealingQueue<QueuedJob>>());
+
+	t_JobSystem = this;
+	t_QueueIndex = 0;
+
+	m_Workers.reserve(workerCount);
+	for (std::uint32_t i = 1; i <= workerCount; ++i)
+		m_Workers.emplace_back(&JobSystem::WorkerLoop, this, i);
+}
+
+/// ----------------------------------------------------------------
+/// JobSystem Dtor
+/// ----------------------------------------------------------------
+
+core::JobSystem::~JobSystem()
+{
+	// Nothing should be left, but don't drop jobs someone may be counting on
+	while (RunOne(GetQueueIndex())) {}
+
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_Running.store(false);
+	}
+	m_WakeUp.notify_all();
+
+	for (auto& worker : m_Workers)
+		worker.join();
+
+	if (t_JobSystem == this)
+		t_JobSystem = nullptr;
+}
+
+/// ----------------------------------------------------------------
+/// JobSystem::DefaultWorkerCount
+/// ----------------------------------------------------------------
+
+std::uint32_t core::JobSystem::DefaultWorkerCount(std::uint32_t otherThreads)
+{
+	// hardware_concurrency may report 0 when it can't tell
+	const std::uint32_t threads = std::thread::hardware_concurrency();
+	return threads > otherThreads + 1 ? threads - otherThreads - 1 : 0;
+}
+
+/// ----------------------------------------------------------------
+/// JobSystem::Run
+/// ----------------------------------------------------------------
+
+void core::JobSystem::Run(Job job, JobCounter& counter)
+{
+	assert(job && "Running an empty job.");
+
+	counter.m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+	// Counted before it's visible, so a thief can never take the count below zero.
+	// Either a worker about to sleep sees it, or this sees the sleeper (see WorkerLoop).
+	m_QueuedJobs.fetch_add(1);
+	m_Queues[GetQueueIndex()]->Push({ std::move(job), &counter });
+
+	if (m_SleepingWorkers.load() > 0)
+	{
+		std::lock_guard<std::mutex> lock(m_SleepMutex);
+		m_WakeUp.notify_one();
+	}
+}
+
+/// ----------------------------------------------------------------
+/// JobSystem::Wait
+/// ----------------------------------------------------------------
+
+void core::JobSystem::Wait(JobCounter& counter)
+{
+	const std::uint32_t index = GetQueueIndex();
+
+	while (!counter.IsDone())
+	{
+		if (!RunOne(index))
+			std::this_thread::yield();
+	}
+}
+
+/// ----------------------------------------------------------------
+/// JobSystem::RunOne
+/// ----------------------------------------------------------------
+
+bool core::JobSystem::RunOne(std::uint32_t index)
+{
+	if (m_QueuedJobs.load(std::memory_order_relaxed) == 0)
+		return false;
+
+	QueuedJob job;
+	bool found = m_Queues[index]->Pop(job);
+
+	// Start with the next deque so that thieves spread over the victims
+	const auto count = static_cast<std::uint32_t>(m_Queues.size());
+	for (std::uint32_t i = 1; i < count && !found; ++i)
+		found = m_Queues[(index + i) % count]->Steal(job);
+
+	if (!found)
+		return false;
+
+	m_QueuedJobs.fetch_sub(1, std::memory_order_relaxed);
+
+	job.function();
+
+	// Destroy the closure first: once the count drops, a Wait() may return and free what it captured
+	job.function = nullptr;
+	job.counter->m_Pending.fetch_sub(1, std::memory_order_release);
+	return true;
+}
+
+/// ----------------------------------------------------------------
+/// JobSystem::WorkerLoop
+/// ----------------------------------------------------------------
+
+void core::JobSystem::WorkerLoop(std::uint32_t index)
+{
+	using Clock = std::chrono::steady_clock;
+
+	t_JobSystem = this;
+	t_QueueIndex = index;
+
+	Clock::time_point idleSince{};
+	bool idle = false;
+
+	while (m_Running.load(std::memory_order_acquire))
+	{
+		if (RunOne(index))
+		{
+			idle = false;
+			continue;
+		}
+
+		// Stay hot for a while, new work usually comes right back
+		if (!idle)
+		{
+			idle = true;
+			idleSince = Clock::now();
+		}
+
+		if (Clock::now() - idleSince < m_SpinTime)
+		{
+			std::this_thread::yield();
+			continue;
+		}
+
+		// Registering as a sleeper before checking the queue count, while
+		// Run() bumps the count before checking for sleepers, means at
+		// least one of the two sides sees the other: no lost wake-up.
+		std::unique_lock<std::mutex> lock(m_SleepMutex);
+		m_SleepingWorkers.fetch_add(1);
+		m_WakeUp.wait(lock, [this] { return m_QueuedJobs.load() > 0 || !m_Running.load(); });
+		m_SleepingWorkers.fetch_sub(1);
+
+		idle = false;
+	}
+}
+
+/// ----------------------------------------------------------------
+/// JobSystem::GetQueueIndex
+/// ----------------------------------------------------------------
+
+std::uint32_t core::JobSystem::GetQueueIndex() const
+{
+	// Threads that aren't ours share the creator's deque
+	return t_JobSystem == this ? t_QueueIndex : 0;
+}
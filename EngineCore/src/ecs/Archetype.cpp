@@ -0,0 +1,171 @@
+#include "ecs/Archetype.h"
+#include <cassert>
+
+/// ----------------------------------------------------------------
+/// Archetype Ctor
+/// ----------------------------------------------------------------
+
+ecs::Archetype::Archetype(const Signature& signature,
+	const std::array<ComponentInfo, MAX_COMPONENTS>& componentInfos)
+	: m_Signature(signature)
+{
+	m_ColumnOfType.fill(INVALID_COLUMN);
+
+	std::size_t rowSize = sizeof(Entity);
+
+	for (std::size_t type = 0; type < MAX_COMPONENTS; ++type)
+	{
+		if (!signature.test(type))
+			continue;
+
+		m_ColumnOfType[type] = static_cast<std::uint32_t>(m_Columns.size());
+		m_Columns.push_back({ static_cast<ComponentType>(type), 0, componentInfos[type] });
+		rowSize += componentInfos[type].size;
+	}
+
+	// Start from the ideal capacity and shrink it until
+	// all the aligned columns fit in a chunk
+	std::uint32_t capacity = static_cast<std::uint32_t>(Chunk::SIZE / rowSize);
+
+	for (; capacity > 0; --capacity)
+	{
+		std::size_t offset = sizeof(Entity) * capacity;
+
+		for (auto& column : m_Columns)
+		{
+			offset = (offset + column.info.alignment - 1) & ~(column.info.alignment - 1);
+			column.offset = offset;
+			offset += column.info.size * capacity;
+		}
+
+		if (offset <= Chunk::SIZE)
+			break;
+	}
+
+	assert(capacity > 0 && "Archetype row does not fit in a chunk.");
+	m_ChunkCapacity = capacity;
+}
+
+/// ----------------------------------------------------------------
+/// Archetype Dtor
+/// ----------------------------------------------------------------
+
+ecs::Archetype::~Archetype()
+{
+	for (auto& chunk : m_Chunks)
+	{
+		for (std::uint32_t column = 0; column < GetColumnCount(); ++column)
+		{
+			std::byte* data = static_cast<std::byte*>(GetColumnData(chunk, column));
+			const ComponentInfo& info = m_Columns[column].info;
+
+			for (std::uint32_t i = 0; i < chunk.count; ++i)
+				info.destroy(data + i * info.size);
+		}
+
+		::operator delete(chunk.data, std::align_val_t{ Chunk::ALIGNMENT });
+	}
+}
+
+/// ----------------------------------------------------------------
+/// Archetype::PushEntity
+/// ----------------------------------------------------------------
+
+std::uint32_t ecs::Archetype::PushEntity(Entity entity)
+{
+	const std::uint32_t row = static_cast<std::uint32_t>(m_EntityCount);
+	const std::size_t chunkIndex = row / m_ChunkCapacity;
+
+	if (chunkIndex == m_Chunks.size())
+	{
+		Chunk chunk;
+		chunk.data = static_cast<std::byte*>(::operator new(Chunk::SIZE, std::align_val_t{ Chunk::ALIGNMENT }));
+		m_Chunks.push_back(chunk);
+		m_ChangeTicks.resize(m_Chunks.size() * m_Columns.size(), 0);
+	}
+
+	Chunk& chunk = m_Chunks[chunkIndex];
+	GetEntities(chunk)[chunk.count] = entity;
+	++chunk.count;
+	++m_EntityCount;
+
+	return row;
+}
+
+/// ----------------------------------------------------------------
+/// Archetype::MarkRowChanged
+/// ----------------------------------------------------------------
+
+void ecs::Archetype::MarkRowChanged(std::uint32_t row, Tick tick)
+{
+	const std::size_t chunk = row / m_ChunkCapacity;
+
+	for (std::uint32_t column = 0; column < GetColumnCount(); ++column)
+		SetChangeTick(chunk, column, tick);
+}
+
+/// ----------------------------------------------------------------
+/// Archetype::RemoveRow
+/// ----------------------------------------------------------------
+
+ecs::Entity ecs::Archetype::RemoveRow(std::uint32_t row, bool destroyComponents)
+{
+	assert(row < m_EntityCount && "Removing non-existent row.");
+
+	const std::uint32_t lastRow = static_cast<std::uint32_t>(m_EntityCount - 1);
+	Chunk& chunk = m_Chunks[row / m_ChunkCapacity];
+	Chunk& lastChunk = m_Chunks[lastRow / m_ChunkCapacity];
+
+	Entity* entities = GetEntities(chunk);
+	Entity* lastEntities = GetEntities(lastChunk);
+	Entity movedEntity = entities[row % m_ChunkCapacity];
+
+	for (std::uint32_t column = 0; column < GetColumnCount(); ++column)
+	{
+		const ComponentInfo& info = m_Columns[column].info;
+		void* slot = GetComponentData(row, column);
+
+		if (destroyComponents)
+			info.destroy(slot);
+
+		// Move the last row into the hole to keep the chunks packed
+		if (row != lastRow)
+		{
+			void* lastSlot = GetComponentData(lastRow, column);
+			info.moveConstruct(slot, lastSlot);
+			info.destroy(lastSlot);
+		}
+	}
+
+	if (row != lastRow)
+	{
+		movedEntity = lastEntities[lastRow % m_ChunkCapacity];
+		entities[row % m_ChunkCapacity] = movedEntity;
+	}
+
+	--lastChunk.count;
+	--m_EntityCount;
+
+	ReleaseUnusedChunks();
+
+	return movedEntity;
+}
+
+/// ----------------------------------------------------------------
+/// Archetype::ReleaseUnusedChunks
+/// ----------------------------------------------------------------
+/// Keeps at most one empty chunk at the tail so an entity moving
+/// back and forth across a chunk boundary doesn't reallocate.
+
+void ecs::Archetype::ReleaseUnusedChunks()
+{
+	const std::size_t usedChunks = (m_EntityCount + m_ChunkCapacity - 1) / m_ChunkCapacity;
+
+	while (m_Chunks.size() > usedChunks + 1)
+	{
+		::operator delete(m_Chunks.back().data, std::align_val_t{ Chunk::ALIGNMENT });
+		m_Chunks.pop_back();
+	}
+
+	m_ChangeTicks.resize(m_Chunks.size() * m_Columns.size());
+}
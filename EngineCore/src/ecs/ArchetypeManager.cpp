@@ -0,0 +1,226 @@
+#include "ecs/ArchetypeManager.h"
+#include <algorithm>
+
+/// ----------------------------------------------------------------
+/// ArchetypeManager::EntityDestroyed
+/// ----------------------------------------------------------------
+
+void ecs::ArchetypeManager::EntityDestroyed(Entity entity)
+{
+	const std::uint32_t index = GetEntityIndex(entity);
+
+	if (index >= m_Records.Size())
+		return;
+
+	EntityRecord& record = m_Records[index];
+
+	if (!record.archetype)
+		return;
+
+	Entity movedEntity = record.archetype->RemoveRow(record.row, true);
+
+	if (movedEntity != entity)
+	{
+		m_Records[GetEntityIndex(movedEntity)].row = record.row;
+		record.archetype->MarkRowChanged(record.row, m_Tick);
+		++m_LayoutVersion;
+	}
+
+	record = EntityRecord{};
+}
+
+/// ----------------------------------------------------------------
+/// ArchetypeManager::CopyComponents
+/// ----------------------------------------------------------------
+
+void ecs::ArchetypeManager::CopyComponents(Entity entity, Prefab& prefab)
+{
+	const EntityRecord& record = GetRecord(entity);
+	Archetype* archetype = record.archetype;
+
+	if (!archetype)
+		return;
+
+	for (std::uint32_t column = 0; column < archetype->GetColumnCount(); ++column)
+		prefab.Set(archetype->GetColumnType(column), archetype->GetColumnInfo(column), archetype->GetComponentData(record.row, column));
+}
+
+/// ----------------------------------------------------------------
+/// ArchetypeManager::Instantiate
+/// ----------------------------------------------------------------
+
+void ecs::ArchetypeManager::Instantiate(std::span<const Entity> entities, const Prefab& prefab)
+{
+	const auto components = prefab.GetComponents();
+
+	// A prefab made of tags only stores nothing
+	if (components.empty() || entities.empty())
+		return;
+
+	Signature signature;
+	for (const Prefab::Component& component : components)
+		signature.set(component.type);
+
+	assert(m_Registered.Contains(signature) && "Component not registered!");
+
+	Archetype* target = GetOrCreateArchetype(signature);
+	const auto first = static_cast<std::uint32_t>(target->GetEntityCount());
+
+	for (Entity entity : entities)
+	{
+		EntityRecord& record = GetRecord(entity);
+
+		assert(!record.archetype && "Instantiating a prefab on an entity that already has components.");
+
+		record.archetype = target;
+		record.row = target->PushEntity(entity);
+	}
+
+	const auto end = static_cast<std::uint32_t>(first + entities.size());
+	const std::uint32_t capacity = target->GetChunkCapacity();
+
+	// One run per chunk the new rows span
+	for (std::uint32_t row = first; row < end; )
+	{
+		const std::uint32_t count = std::min(end - row, capacity - row % capacity);
+
+		for (const Prefab::Component& component : components)
+			component.info.fillConstruct(target->GetComponentData(row, target->GetColumn(component.type)), component.data, count);
+
+		target->MarkRowChanged(row, m_Tick);
+		row += count;
+	}
+}
+
+/// ----------------------------------------------------------------
+/// ArchetypeManager::GetRecord
+/// ----------------------------------------------------------------
+
+ecs::ArchetypeManager::EntityRecord& ecs::ArchetypeManager::GetRecord(Entity entity)
+{
+	// Records grow with the highest entity index seen
+	const std::uint32_t index = GetEntityIndex(entity);
+
+	while (m_Records.Size() <= index)
+		m_Records.EmplaceBack();
+
+	return m_Records[index];
+}
+
+/// ----------------------------------------------------------------
+/// ArchetypeManager::GetOrCreateArchetype
+/// ----------------------------------------------------------------
+
+ecs::Archetype* ecs::ArchetypeManager::GetOrCreateArchetype(const Signature& signature)
+{
+	// Entities without components are not stored in any archetype
+	if (signature.none())
+		return nullptr;
+
+	auto it = m_ArchetypeLookup.find(signature);
+
+	if (it != m_ArchetypeLookup.end())
+		return it->second;
+
+	auto archetype = std::make_unique<Archetype>(signature, m_ComponentInfos);
+	Archetype* ptr = archetype.get();
+
+	m_Archetypes.emplace_back(std::move(archetype));
+	m_ArchetypeLookup.insert({ signature, ptr });
+
+	return ptr;
+}
+
+/// ----------------------------------------------------------------
+/// ArchetypeManager::GetAddTarget
+/// ----------------------------------------------------------------
+
+ecs::Archetype* ecs::ArchetypeManager::GetAddTarget(Archetype* source, ComponentType type)
+{
+	if (!source)
+	{
+		Signature signature;
+		signature.set(type);
+		return GetOrCreateArchetype(signature);
+	}
+
+	// Edges are cached so the signature lookup happens once per transition
+	Archetype*& edge = source->AddEdge(type);
+
+	if (!edge)
+	{
+		Signature signature = source->GetSignature();
+		signature.set(type);
+		edge = GetOrCreateArchetype(signature);
+	}
+
+	return edge;
+}
+
+/// ----------------------------------------------------------------
+/// ArchetypeManager::GetRemoveTarget
+/// ----------------------------------------------------------------
+
+ecs::Archetype* ecs::ArchetypeManager::GetRemoveTarget(Archetype* source, ComponentType type)
+{
+	Archetype*& edge = source->RemoveEdge(type);
+
+	if (!edge)
+	{
+		Signature signature = source->GetSignature();
+		signature.reset(type);
+		edge = GetOrCreateArchetype(signature);
+	}
+
+	return edge;
+}
+
+/// ----------------------------------------------------------------
+/// ArchetypeManager::MoveEntity
+/// ----------------------------------------------------------------
+
+void ecs::ArchetypeManager::MoveEntity(Entity entity, EntityRecord& record, Archetype* target)
+{
+	Archetype* source = record.archetype;
+	std::uint32_t targetRow = 0;
+
+	if (target)
+	{
+		targetRow = target->PushEntity(entity);
+		target->MarkRowChanged(targetRow, m_Tick);
+	}
+
+	if (source)
+	{
+		// Move the components both archetypes have, destroy the dropped ones
+		for (std::uint32_t column = 0; column < source->GetColumnCount(); ++column)
+		{
+			const ComponentInfo& info = source->GetColumnInfo(column);
+			void* src = source->GetComponentData(record.row, column);
+
+			if (target)
+			{
+				const std::uint32_t targetColumn = target->GetColumn(source->GetColumnType(column));
+
+				if (targetColumn != Archetype::INVALID_COLUMN)
+					info.moveConstruct(target->GetComponentData(targetRow, targetColumn), src);
+			}
+
+			info.destroy(src);
+		}
+
+		Entity movedEntity = source->RemoveRow(record.row, false);
+
+		if (movedEntity != entity)
+		{
+			m_Records[GetEntityIndex(movedEntity)].row = record.row;
+			source->MarkRowChanged(record.row, m_Tick);
+		}
+
+		// The entity itself changes place, even if it keeps all its memberships
+		++m_LayoutVersion;
+	}
+
+	record.archetype = target;
+	record.row = targetRow;
+}
@@ -0,0 +1,63 @@
+#include "ecs/CommandBuffer.h"
+
+/// ----------------------------------------------------------------
+/// CommandBuffer::DestroyEntity
+/// ----------------------------------------------------------------
+
+void ecs::CommandBuffer::DestroyEntity(Entity entity)
+{
+	if (m_DestroyIndex.Contains(entity))
+		return;
+
+	m_DestroyIndex.Set(entity, static_cast<SparseIndex::Index>(m_Destroyed.size()));
+	m_Destroyed.push_back(entity);
+}
+
+/// ----------------------------------------------------------------
+/// CommandBuffer::Flush
+/// ----------------------------------------------------------------
+
+void ecs::CommandBuffer::Flush(Coordinator& coordinator)
+{
+	// Entities reserved by jobs may be the target of the commands
+	coordinator.FlushReservedEntities();
+
+	// Destroy first, the pools then skip the dead entities.
+	// Sorted so the per-entity storage is walked in index order.
+	std::sort(m_Destroyed.begin(), m_Destroyed.end(),
+		[](Entity lhs, Entity rhs) { return GetEntityIndex(lhs) < GetEntityIndex(rhs); });
+
+	for (Entity entity : m_Destroyed)
+	{
+		if (coordinator.IsAlive(entity))
+			coordinator.DestroyEntity(entity);
+	}
+
+	// One batch per component type, in type order
+	std::sort(m_UsedPools.begin(), m_UsedPools.end());
+
+	for (ComponentType type : m_UsedPools)
+		m_Pools[type]->Apply(coordinator);
+
+	Clear();
+}
+
+/// ----------------------------------------------------------------
+/// CommandBuffer::Clear
+/// ----------------------------------------------------------------
+
+void ecs::CommandBuffer::Clear()
+{
+	for (Entity entity : m_Destroyed)
+		m_DestroyIndex.Erase(entity);
+
+	m_Destroyed.clear();
+
+	for (ComponentType type : m_UsedPools)
+	{
+		m_Pools[type]->Clear();
+		m_Used.reset(type);
+	}
+
+	m_UsedPools.clear();
+}
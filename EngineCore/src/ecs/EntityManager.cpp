@@ -1,16 +1,16 @@
 #include "ecs/EntityManager.h"
 #include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
 
-/// ----------------------------------------------------------------
-/// EntityManager Ctor
-/// ----------------------------------------------------------------
+namespace {
 
-ecs::EntityManager::EntityManager()
-{
-	// init the queue with all possible ideas
-	for (Entity entity = 0; entity < MAX_ENTITIES; ++entity)
+	// Checked in release builds too: MakeEntity would wrap the index onto a living entity
+	[[noreturn]] void IndexSpaceExhausted()
 	{
-		m_AvailableEntities.push(entity);
+		std::fprintf(stderr, "ecs: entity index space exhausted, all %u indices are alive or retired.\n", ecs::ENTITY_INDEX_MASK);
+		std::abort();
 	}
 }
 
@@ -20,43 +20,170 @@ ecs::EntityManager::EntityManager()
 
 ecs::Entity ecs::EntityManager::CreateEntity()
 {
-	Entity id = m_AvailableEntities.front();
-	m_AvailableEntities.pop();
+	// The reserved IDs come first in the free list
+	if (HasReserved())
+		FlushReserved();
+
+	Entity id;
+
+	if (!m_AvailableEntities.empty())
+	{
+		// Reuse a released slot, the free list already carries its new generation
+		id = m_AvailableEntities.front();
+		m_AvailableEntities.pop_front();
+		m_Handles[GetEntityIndex(id)] = id;
+	}
+	else
+	{
+		// No free index, mint a new one and grow the per-entity storage
+		const auto index = static_cast<std::uint32_t>(m_Handles.Size());
+		if (index >= ENTITY_INDEX_MASK)
+			IndexSpaceExhausted();
+
+		id = MakeEntity(index, 0);
+		m_Handles.PushBack(id);
+		m_Signatures.EmplaceBack();
+	}
+
 	++m_LivingEntityCount;
 	return id;
 }
 
+/// ----------------------------------------------------------------
+/// EntityManager::CreateEntities
+/// ----------------------------------------------------------------
+
+void ecs::EntityManager::CreateEntities(std::span<Entity> out)
+{
+	if (HasReserved())
+		FlushReserved();
+
+	// Only the IDs that can't be recycled need new slots
+	const std::size_t recycled = std::min(out.size(), m_AvailableEntities.size());
+	const std::size_t minted = out.size() - recycled;
+
+	m_Handles.Reserve(m_Handles.Size() + minted);
+	m_Signatures.Reserve(m_Signatures.Size() + minted);
+
+	for (auto& entity : out)
+		entity = CreateEntity();
+}
+
 /// ----------------------------------------------------------------
 /// EntityManager::DestroyEntity
 /// ----------------------------------------------------------------
 
 void ecs::EntityManager::DestroyEntity(Entity entity)
 {
-	assert(entity < MAX_ENTITIES && "Entity out of range.");
+	// A reserved ID may be destroyed before the sync point, and the free list must not move under the reservations
+	if (HasReserved())
+		FlushReserved();
+
+	assert(IsAlive(entity) && "Destroying dead or stale entity.");
 
-	m_Signatures[entity].reset();
-	m_AvailableEntities.push(entity);
+	const std::uint32_t index = GetEntityIndex(entity);
 
+	m_Signatures[index].reset();
+	m_Handles[index] = NULL_ENTITY;
 	--m_LivingEntityCount;
+
+	// A slot whose generation ran out is retired: wrapping would revive its first handles
+	if (GetEntityGeneration(entity) == ENTITY_GENERATION_MASK)
+		return;
+
+	// The next entity gets a bumped generation, so every handle still around stays stale
+	m_AvailableEntities.push_back(MakeEntity(index, GetEntityGeneration(entity) + 1));
+}
+
+/// ----------------------------------------------------------------
+/// EntityManager::ReserveEntity
+/// ----------------------------------------------------------------
+
+ecs::Entity ecs::EntityManager::ReserveEntity()
+{
+	// Nothing is written, the order of the flush tells which ID each add got
+	return GetReservedEntity(m_Reserved.fetch_add(1, std::memory_order_relaxed));
+}
+
+/// ----------------------------------------------------------------
+/// EntityManager::ReserveEntities
+/// ----------------------------------------------------------------
+
+void ecs::EntityManager::ReserveEntities(std::span<Entity> out)
+{
+	const std::uint32_t first = m_Reserved.fetch_add(static_cast<std::uint32_t>(out.size()), std::memory_order_relaxed);
+
+	for (std::uint32_t i = 0; i < out.size(); ++i)
+		out[i] = GetReservedEntity(first + i);
+}
+
+/// ----------------------------------------------------------------
+/// EntityManager::FlushReserved
+/// ----------------------------------------------------------------
+
+void ecs::EntityManager::FlushReserved()
+{
+	// Called at a sync point, the jobs that reserved are done
+	const std::uint32_t reserved = m_Reserved.exchange(0, std::memory_order_acquire);
+
+	if (reserved == 0)
+		return;
+
+	const std::size_t recycled = std::min<std::size_t>(reserved, m_AvailableEntities.size());
+	const std::size_t minted = reserved - recycled;
+
+	// The recycled slots take the handles that were given out
+	for (std::size_t i = 0; i < recycled; ++i)
+		m_Handles[GetEntityIndex(m_AvailableEntities[i])] = m_AvailableEntities[i];
+
+	m_AvailableEntities.erase(m_AvailableEntities.begin(), m_AvailableEntities.begin() + recycled);
+
+	m_Handles.Reserve(m_Handles.Size() + minted);
+	m_Signatures.Reserve(m_Signatures.Size() + minted);
+
+	for (std::size_t i = 0; i < minted; ++i)
+	{
+		m_Handles.PushBack(MakeEntity(static_cast<std::uint32_t>(m_Handles.Size()), 0));
+		m_Signatures.EmplaceBack();
+	}
+
+	m_LivingEntityCount += reserved;
+}
+
+/// ----------------------------------------------------------------
+/// EntityManager::GetReservedEntity
+/// ----------------------------------------------------------------
+
+ecs::Entity ecs::EntityManager::GetReservedEntity(std::uint32_t reservation) const
+{
+	// Only read here: the storage doesn't change until the next flush
+	if (reservation < m_AvailableEntities.size())
+		return m_AvailableEntities[reservation];
+
+	const std::size_t index = m_Handles.Size() + (reservation - m_AvailableEntities.size());
+	if (index >= ENTITY_INDEX_MASK)
+		IndexSpaceExhausted();
+
+	return MakeEntity(static_cast<std::uint32_t>(index), 0);
 }
 
 /// ----------------------------------------------------------------
 /// EntityManager::SetSignature
 /// ----------------------------------------------------------------
 
-void ecs::EntityManager::SetSignature(Entity entity, std::bitset<MAX_COMPONENTS> in_Signature)
+void ecs::EntityManager::SetSignature(Entity entity, const Signature& in_Signature)
 {
-	assert(entity < MAX_ENTITIES && "Entity out of range.");
-	m_Signatures[entity] = in_Signature;
+	assert(IsAlive(entity) && "Entity is not alive.");
+	m_Signatures[GetEntityIndex(entity)] = in_Signature;
 }
 
 /// ----------------------------------------------------------------
 /// EntityManager::GetSignature
 /// ----------------------------------------------------------------
 
-std::bitset<ecs::MAX_COMPONENTS> ecs::EntityManager::GetSignature(Entity entity) const
+const ecs::Signature& ecs::EntityManager::GetSignature(Entity entity) const
 {
-	assert(entity < MAX_ENTITIES && "Entity out of range.");
+	assert(IsAlive(entity) && "Entity is not alive.");
 
-	return m_Signatures[entity];
+	return m_Signatures[GetEntityIndex(entity)];
 }
@@ -0,0 +1,212 @@
+#include "ecs/systems/HierarchySystem.h"
+#include <algorithm>
+#include <cassert>
+
+/// ----------------------------------------------------------------
+/// HierarchySystem::SetParent
+/// ----------------------------------------------------------------
+
+void ecs::HierarchySystem::SetParent(Coordinator& coordinator, Entity child, Entity parent)
+{
+	assert(coordinator.IsAlive(child) && coordinator.IsAlive(parent) && "Parenting dead or stale entities.");
+	assert(!IsAncestor(coordinator, child, parent) && "Parenting would create a cycle.");
+
+	RemoveParent(coordinator, child);
+
+	coordinator.AddComponent<Parent>(child, Parent{ parent });
+
+	if (!coordinator.HasComponent<Children>(parent))
+		coordinator.AddComponent<Children>(parent, Children{});
+
+	coordinator.GetComponent<Children>(parent).entities.push_back(child);
+	m_HierarchyChanged = true;
+}
+
+/// ----------------------------------------------------------------
+/// HierarchySystem::RemoveParent
+/// ----------------------------------------------------------------
+
+void ecs::HierarchySystem::RemoveParent(Coordinator& coordinator, Entity child)
+{
+	if (!coordinator.HasComponent<Parent>(child))
+		return;
+
+	const Entity parent = coordinator.GetComponent<const Parent>(child).entity;
+
+	if (coordinator.IsAlive(parent) && coordinator.HasComponent<Children>(parent))
+	{
+		std::vector<Entity>& siblings = coordinator.GetComponent<Children>(parent).entities;
+		std::erase(siblings, child);
+
+		if (siblings.empty())
+			coordinator.RemoveComponent<Children>(parent);
+	}
+
+	coordinator.RemoveComponent<Parent>(child);
+	m_HierarchyChanged = true;
+}
+
+/// ----------------------------------------------------------------
+/// HierarchySystem::DestroyHierarchy
+/// ----------------------------------------------------------------
+
+void ecs::HierarchySystem::DestroyHierarchy(Coordinator& coordinator, Entity root)
+{
+	RemoveParent(coordinator, root);
+
+	std::vector<Entity> pending{ root };
+
+	while (!pending.empty())
+	{
+		const Entity entity = pending.back();
+		pending.pop_back();
+
+		if (coordinator.HasComponent<Children>(entity))
+		{
+			const std::vector<Entity>& children = coordinator.GetComponent<const Children>(entity).entities;
+			pending.insert(pending.end(), children.begin(), children.end());
+		}
+
+		coordinator.DestroyEntity(entity);
+	}
+
+	m_HierarchyChanged = true;
+}
+
+/// ----------------------------------------------------------------
+/// HierarchySystem::Update
+/// ----------------------------------------------------------------
+
+void ecs::HierarchySystem::Update(Coordinator& coordinator)
+{
+	if (m_HierarchyChanged || m_Entities.IsDirty())
+		Rebuild(coordinator);
+	else if (coordinator.GetLayoutVersion<LocalTransform>() != m_LocalLayout
+		|| coordinator.GetLayoutVersion<WorldTransform>() != m_WorldLayout)
+		Arrange(coordinator);
+
+	coordinator.ForEachChanged<const LocalTransform>(m_LastRunTick, [this](Entity entity, const LocalTransform&) {
+
+		const auto slot = m_Slots.Find(entity);
+
+		if (slot != SparseIndex::INVALID_INDEX)
+			m_Dirty[slot] = 1;
+	});
+
+	// Parents come first, so a dirty parent has already dirtied
+	// its slot when the children are reached
+	for (std::size_t i = 0; i < m_Order.size(); ++i)
+	{
+		const std::uint32_t parent = m_ParentSlots[i];
+
+		if (parent != NO_PARENT)
+			m_Dirty[i] |= m_Dirty[parent];
+
+		if (!m_Dirty[i])
+			continue;
+
+		const Entity entity = m_Order[i];
+		adg::Transform world = coordinator.GetComponent<const LocalTransform>(entity).value;
+
+		if (parent != NO_PARENT)
+			world.cumulate_with(m_WorldTransforms[parent]);
+
+		m_WorldTransforms[i] = world;
+		coordinator.GetComponent<WorldTransform>(entity).value = world;
+	}
+
+	std::fill(m_Dirty.begin(), m_Dirty.end(), std::uint8_t(0));
+	m_LastRunTick = coordinator.GetTick();
+}
+
+/// ----------------------------------------------------------------
+/// HierarchySystem::Rebuild
+/// ----------------------------------------------------------------
+
+void ecs::HierarchySystem::Rebuild(Coordinator& coordinator)
+{
+	for (Entity entity : m_Order)
+		m_Slots.Erase(entity);
+
+	m_Order.clear();
+	m_ParentSlots.clear();
+	m_Order.reserve(m_Entities.Size());
+	m_ParentSlots.reserve(m_Entities.Size());
+
+	// Roots: no parent, or a parent that isn't part of the hierarchy (anymore)
+	for (Entity entity : m_Entities)
+	{
+		const bool attached = coordinator.HasComponent<Parent>(entity)
+			&& m_Entities.Contains(coordinator.GetComponent<const Parent>(entity).entity)
+			&& coordinator.IsAlive(coordinator.GetComponent<const Parent>(entity).entity);
+
+		if (!attached)
+			PushSlot(entity, NO_PARENT);
+	}
+
+	// Breadth-first: each depth level is appended after the previous one
+	for (std::size_t i = 0; i < m_Order.size(); ++i)
+	{
+		const Entity entity = m_Order[i];
+
+		if (!coordinator.HasComponent<Children>(entity))
+			continue;
+
+		for (Entity child : coordinator.GetComponent<const Children>(entity).entities)
+		{
+			if (m_Entities.Contains(child))
+				PushSlot(child, static_cast<std::uint32_t>(i));
+		}
+	}
+
+	assert(m_Order.size() == m_Entities.Size() && "Parent and Children out of sync, use HierarchySystem::SetParent.");
+
+	// Same order for the member list and the transform storage
+	m_Entities.Sort([this](Entity entity) { return m_Slots.Get(entity); });
+	Arrange(coordinator);
+
+	m_WorldTransforms.resize(m_Order.size());
+	m_Dirty.assign(m_Order.size(), 1);
+	m_HierarchyChanged = false;
+}
+
+/// ----------------------------------------------------------------
+/// HierarchySystem::Arrange
+/// ----------------------------------------------------------------
+
+void ecs::HierarchySystem::Arrange(Coordinator& coordinator)
+{
+	coordinator.ArrangeComponents<LocalTransform>(m_Order);
+	coordinator.ArrangeComponents<WorldTransform>(m_Order);
+
+	// Arranging moves them too, so the versions are read afterwards
+	m_LocalLayout = coordinator.GetLayoutVersion<LocalTransform>();
+	m_WorldLayout = coordinator.GetLayoutVersion<WorldTransform>();
+}
+
+/// ----------------------------------------------------------------
+/// HierarchySystem::PushSlot
+/// ----------------------------------------------------------------
+
+void ecs::HierarchySystem::PushSlot(Entity entity, std::uint32_t parentSlot)
+{
+	m_Slots.Set(entity, static_cast<SparseIndex::Index>(m_Order.size()));
+	m_Order.push_back(entity);
+	m_ParentSlots.push_back(parentSlot);
+}
+
+/// ----------------------------------------------------------------
+/// HierarchySystem::IsAncestor
+/// ----------------------------------------------------------------
+
+bool ecs::HierarchySystem::IsAncestor(Coordinator& coordinator, Entity ancestor, Entity entity) const
+{
+	for (Entity current = entity; ; current = coordinator.GetComponent<const Parent>(current).entity)
+	{
+		if (current == ancestor)
+			return true;
+
+		if (!coordinator.IsAlive(current) || !coordinator.HasComponent<Parent>(current))
+			return false;
+	}
+}
@@ -0,0 +1,219 @@
+#include "ecs/ObserverManager.h"
+#include <algorithm>
+#include <cassert>
+
+/// ----------------------------------------------------------------
+/// ObserverManager::Register
+/// ----------------------------------------------------------------
+
+ecs::ObserverID ecs::ObserverManager::Register(ObserverEvent event, ComponentType type, ObserverCallback callback)
+{
+	assert(callback && "Observer without a callback.");
+
+	const ObserverID id = m_NextID++;
+	const auto e = static_cast<std::size_t>(event);
+
+	m_Observers[e][type].push_back({ id, std::move(callback) });
+	m_Observed[e].set(type);
+	m_ObservedTypes.set(type);
+
+	return id;
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::Unregister
+/// ----------------------------------------------------------------
+
+void ecs::ObserverManager::Unregister(ObserverID id)
+{
+	for (std::size_t e = 0; e < EVENT_COUNT; ++e)
+	{
+		for (std::size_t type = 0; type < MAX_COMPONENTS; ++type)
+		{
+			auto& observers = m_Observers[e][type];
+
+			if (std::erase_if(observers, [id](const Observer& observer) { return observer.id == id; }) == 0)
+				continue;
+
+			// Keep the type recorded while something still listens to it
+			if (observers.empty())
+				m_Observed[e].reset(type);
+
+			const bool observed = m_Observed[0].test(type) || m_Observed[1].test(type) || m_Observed[2].test(type);
+			m_ObservedTypes.set(type, observed);
+			return;
+		}
+	}
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::ComponentAdded
+/// ----------------------------------------------------------------
+
+void ecs::ObserverManager::ComponentAdded(ComponentType type, Entity entity)
+{
+	if (m_Observed[static_cast<std::size_t>(ObserverEvent::Add)].test(type))
+		GetQueue(ObserverEvent::Add, type).Push(entity);
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::ComponentRemoved
+/// ----------------------------------------------------------------
+
+void ecs::ObserverManager::ComponentRemoved(ComponentType type, Entity entity)
+{
+	Queue& added = m_Queues[static_cast<std::size_t>(ObserverEvent::Add)][type];
+	Queue& set = m_Queues[static_cast<std::size_t>(ObserverEvent::Set)][type];
+
+	// Removed by a callback: the batches of this flush still to come mustn't report it
+	Queue& flushingAdded = m_Flushing[static_cast<std::size_t>(ObserverEvent::Add)][type];
+	Queue& flushingSet = m_Flushing[static_cast<std::size_t>(ObserverEvent::Set)][type];
+
+	if (set.Contains(entity))
+		set.Erase(entity);
+
+	if (flushingSet.Contains(entity))
+		flushingSet.Erase(entity);
+
+	// Added since the last flush: nobody heard of it, nothing to report
+	if (added.Contains(entity))
+	{
+		added.Erase(entity);
+		return;
+	}
+
+	if (flushingAdded.Contains(entity))
+	{
+		flushingAdded.Erase(entity);
+		return;
+	}
+
+	if (m_Observed[static_cast<std::size_t>(ObserverEvent::Remove)].test(type))
+		GetQueue(ObserverEvent::Remove, type).Push(entity);
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::ComponentSet
+/// ----------------------------------------------------------------
+
+void ecs::ObserverManager::ComponentSet(ComponentType type, Entity entity)
+{
+	if (!m_Observed[static_cast<std::size_t>(ObserverEvent::Set)].test(type))
+		return;
+
+	// Systems run by the Scheduler may set components concurrently
+	std::lock_guard<std::mutex> lock(m_SetMutex);
+
+	// The add batch already covers it, and a set is reported once
+	if (m_Queues[static_cast<std::size_t>(ObserverEvent::Add)][type].Contains(entity))
+		return;
+
+	Queue& set = GetQueue(ObserverEvent::Set, type);
+
+	if (!set.Contains(entity))
+		set.Push(entity);
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::EntityDestroyed
+/// ----------------------------------------------------------------
+
+void ecs::ObserverManager::EntityDestroyed(Entity entity, const Signature& signature)
+{
+	(signature & m_ObservedTypes).ForEachSet([this, entity](ComponentType type) { ComponentRemoved(type, entity); });
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::Flush
+/// ----------------------------------------------------------------
+
+void ecs::ObserverManager::Flush()
+{
+	// Types queued by the callbacks are flushed next time
+	std::vector<ComponentType> types;
+	types.swap(m_PendingTypes);
+	m_Pending.reset();
+
+	std::sort(types.begin(), types.end());
+
+	// Take every batch out before any callback runs, what they queue goes to the emptied queues
+	for (ComponentType type : types)
+	{
+		for (std::size_t e = 0; e < EVENT_COUNT; ++e)
+			std::swap(m_Queues[e][type], m_Flushing[e][type]);
+	}
+
+	for (ComponentType type : types)
+	{
+		Deliver(ObserverEvent::Remove, type);
+		Deliver(ObserverEvent::Add, type);
+		Deliver(ObserverEvent::Set, type);
+	}
+
+	// Hand the capacity back for the next flush
+	if (m_PendingTypes.empty())
+	{
+		types.clear();
+		m_PendingTypes.swap(types);
+	}
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::Deliver
+/// ----------------------------------------------------------------
+
+void ecs::ObserverManager::Deliver(ObserverEvent event, ComponentType type)
+{
+	Queue& queue = m_Flushing[static_cast<std::size_t>(event)][type];
+
+	if (queue.entities.empty())
+		return;
+
+	// Take the batch out first: the callbacks may drop entities from the flushing queues
+	for (Entity entity : queue.entities)
+		queue.index.Erase(entity);
+
+	m_Delivering.swap(queue.entities);
+
+	for (const Observer& observer : m_Observers[static_cast<std::size_t>(event)][type])
+		observer.callback(m_Delivering);
+
+	m_Delivering.clear();
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::GetQueue
+/// ----------------------------------------------------------------
+
+ecs::ObserverManager::Queue& ecs::ObserverManager::GetQueue(ObserverEvent event, ComponentType type)
+{
+	if (!m_Pending.test(type))
+	{
+		m_Pending.set(type);
+		m_PendingTypes.push_back(type);
+	}
+
+	return m_Queues[static_cast<std::size_t>(event)][type];
+}
+
+/// ----------------------------------------------------------------
+/// ObserverManager::Queue
+/// ----------------------------------------------------------------
+
+void ecs::ObserverManager::Queue::Push(Entity entity)
+{
+	index.Set(entity, static_cast<SparseIndex::Index>(entities.size()));
+	entities.push_back(entity);
+}
+
+void ecs::ObserverManager::Queue::Erase(Entity entity)
+{
+	// Swap with the last one, the delivery order doesn't matter
+	const auto position = index.Get(entity);
+	const Entity last = entities.back();
+
+	entities[position] = last;
+	index.Set(last, position);
+	entities.pop_back();
+	index.Erase(entity);
+}
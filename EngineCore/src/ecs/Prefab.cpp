@@ -0,0 +1,156 @@
+#include "ecs/Prefab.h"
+#include <algorithm>
+#include <new>
+#include <utility>
+
+/// ----------------------------------------------------------------
+/// Prefab::Dtor
+/// ----------------------------------------------------------------
+
+ecs::Prefab::~Prefab()
+{
+	Clear();
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Copy
+/// ----------------------------------------------------------------
+
+ecs::Prefab::Prefab(const Prefab& other)
+	: m_Signature(other.m_Signature)
+{
+	m_Components.reserve(other.m_Components.size());
+
+	for (const Component& component : other.m_Components)
+	{
+		Component copy{ component.type, component.info, Allocate(component.info) };
+		component.info.fillConstruct(copy.data, component.data, 1);
+		m_Components.push_back(copy);
+	}
+}
+
+ecs::Prefab& ecs::Prefab::operator=(const Prefab& other)
+{
+	if (this != &other)
+		*this = Prefab(other);
+
+	return *this;
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Move
+/// ----------------------------------------------------------------
+
+ecs::Prefab::Prefab(Prefab&& other) noexcept
+	: m_Components(std::exchange(other.m_Components, {})), m_Signature(std::exchange(other.m_Signature, {}))
+{
+}
+
+ecs::Prefab& ecs::Prefab::operator=(Prefab&& other) noexcept
+{
+	if (this != &other)
+	{
+		Clear();
+		m_Components = std::exchange(other.m_Components, {});
+		m_Signature = std::exchange(other.m_Signature, {});
+	}
+
+	return *this;
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Set
+/// ----------------------------------------------------------------
+
+void ecs::Prefab::Set(ComponentType type, const ComponentInfo& info, const void* component)
+{
+	// Setting a value to itself
+	if (const Component* existing = Find(type); existing && existing->data == component)
+		return;
+
+	info.fillConstruct(Emplace(type, info), component, 1);
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Emplace
+/// ----------------------------------------------------------------
+
+void* ecs::Prefab::Emplace(ComponentType type, const ComponentInfo& info)
+{
+	auto it = std::lower_bound(m_Components.begin(), m_Components.end(), type,
+		[](const Component& c, ComponentType t) { return c.type < t; });
+
+	m_Signature.set(type);
+
+	// Reuse the allocation of the value being replaced
+	if (it != m_Components.end() && it->type == type)
+	{
+		it->info.destroy(it->data);
+		return it->data;
+	}
+
+	return m_Components.insert(it, Component{ type, info, Allocate(info) })->data;
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Remove
+/// ----------------------------------------------------------------
+
+void ecs::Prefab::Remove(ComponentType type)
+{
+	auto it = std::find_if(m_Components.begin(), m_Components.end(),
+		[type](const Component& c) { return c.type == type; });
+
+	if (it != m_Components.end())
+	{
+		Release(*it);
+		m_Components.erase(it);
+	}
+
+	m_Signature.reset(type);
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Find
+/// ----------------------------------------------------------------
+
+const ecs::Prefab::Component* ecs::Prefab::Find(ComponentType type) const
+{
+	auto it = std::lower_bound(m_Components.begin(), m_Components.end(), type,
+		[](const Component& c, ComponentType t) { return c.type < t; });
+
+	return it != m_Components.end() && it->type == type ? &*it : nullptr;
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Allocate
+/// ----------------------------------------------------------------
+
+void* ecs::Prefab::Allocate(const ComponentInfo& info)
+{
+	return ::operator new(info.size, std::align_val_t{ info.alignment });
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Release
+/// ----------------------------------------------------------------
+
+void ecs::Prefab::Release(Component& component)
+{
+	component.info.destroy(component.data);
+	::operator delete(component.data, std::align_val_t{ component.info.alignment });
+	component.data = nullptr;
+}
+
+/// ----------------------------------------------------------------
+/// Prefab::Clear
+/// ----------------------------------------------------------------
+
+void ecs::Prefab::Clear()
+{
+	for (Component& component : m_Components)
+		Release(component);
+
+	m_Components.clear();
+	m_Signature.reset();
+}
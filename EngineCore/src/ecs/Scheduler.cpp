@@ -0,0 +1,284 @@
+#include "ecs/Scheduler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cassert>
+
+namespace {
+
+	double Milliseconds(std::chrono::steady_clock::duration duration)
+	{
+		return std::chrono::duration<double, std::milli>(duration).count();
+	}
+}
+
+/// ----------------------------------------------------------------
+/// Scheduler::Add
+/// ----------------------------------------------------------------
+
+void ecs::Scheduler::Add(std::string name, const SystemAccess& access, SystemFunction function)
+{
+	assert(function && "Scheduling a system without a function.");
+
+	auto node = std::make_unique<Node>();
+	node->name = std::move(name);
+	node->access = access;
+	node->function = std::move(function);
+
+	m_Nodes.push_back(std::move(node));
+	m_Dirty = true;
+}
+
+/// ----------------------------------------------------------------
+/// Scheduler::Build
+/// ----------------------------------------------------------------
+
+void ecs::Scheduler::Build()
+{
+	m_Phases.clear();
+
+	for (std::uint32_t j = 0; j < m_Nodes.size(); ++j)
+	{
+		Node& node = *m_Nodes[j];
+		node.phase = 0;
+		node.predecessors.clear();
+		node.successors.clear();
+
+		// An earlier conflicting system comes first, in a later phase if its changes are deferred
+		// or if this one writes what it uses: the tick it recorded must be older than those writes
+		for (std::uint32_t i = 0; i < j; ++i)
+		{
+			const Node& earlier = *m_Nodes[i];
+
+			if (!earlier.access.ConflictsWith(node.access))
+				continue;
+
+			const bool nextPhase = earlier.access.deferred || node.access.writes.Intersects(earlier.access.reads | earlier.access.writes);
+			node.phase = std::max(node.phase, earlier.phase + (nextPhase ? 1u : 0u));
+		}
+
+		for (std::uint32_t i = 0; i < j; ++i)
+		{
+			Node& earlier = *m_Nodes[i];
+
+			if (earlier.phase == node.phase && earlier.access.ConflictsWith(node.access))
+			{
+				node.predecessors.push_back(i);
+				earlier.successors.push_back(j);
+			}
+		}
+
+		if (node.phase >= m_Phases.size())
+			m_Phases.resize(node.phase + 1);
+
+		m_Phases[node.phase].push_back(j);
+	}
+
+	m_Dirty = false;
+}
+
+/// ----------------------------------------------------------------
+/// Scheduler::Run
+/// ----------------------------------------------------------------
+
+void ecs::Scheduler::Run(Coordinator& coordinator, core::JobSystem& jobs, float deltaTime)
+{
+	if (m_Dirty)
+		Build();
+
+	const Clock::time_point frameStart = Clock::now();
+
+	m_Frame.coordinator = &coordinator;
+	m_Frame.jobs = &jobs;
+	m_Frame.deltaTime = deltaTime;
+
+	std::vector<double> syncMs;
+	syncMs.reserve(m_Phases.size());
+
+	for (const auto& phase : m_Phases)
+	{
+		// The phase's changes compare newer than what the systems before it recorded
+		coordinator.AdvanceTick();
+
+		coordinator.SetPhaseRunning(true);
+		RunPhase(phase);
+		coordinator.SetPhaseRunning(false);
+
+		// Sync point: the phase is over, apply its structural changes in a fixed order
+		const Clock::time_point syncStart = Clock::now();
+
+		coordinator.FlushReservedEntities();
+
+		for (std::uint32_t index : phase)
+		{
+			if (!m_Nodes[index]->commands.Empty())
+				m_Nodes[index]->commands.Flush(coordinator);
+		}
+
+		syncMs.push_back(Milliseconds(Clock::now() - syncStart));
+	}
+
+	m_Frame = {};
+
+	BuildReport(frameStart, Clock::now(), syncMs);
+}
+
+/// ----------------------------------------------------------------
+/// Scheduler::RunPhase
+/// ----------------------------------------------------------------
+
+void ecs::Scheduler::RunPhase(const std::vector<std::uint32_t>& phase)
+{
+	core::JobCounter counter;
+	m_Frame.counter = &counter;
+
+	// Every count is set before the first job can decrement one
+	for (std::uint32_t index : phase)
+		m_Nodes[index]->pending.store(static_cast<std::uint32_t>(m_Nodes[index]->predecessors.size()), std::memory_order_relaxed);
+
+	for (std::uint32_t index : phase)
+	{
+		if (m_Nodes[index]->predecessors.empty())
+			m_Frame.jobs->Run([this, index] { RunNode(index); }, counter);
+	}
+
+	m_Frame.jobs->Wait(counter);
+	m_Frame.counter = nullptr;
+}
+
+/// ----------------------------------------------------------------
+/// Scheduler::RunNode
+/// ----------------------------------------------------------------
+
+void ecs::Scheduler::RunNode(std::uint32_t index)
+{
+	Node& node = *m_Nodes[index];
+
+	SystemContext context{ *m_Frame.coordinator, *m_Frame.jobs, node.commands, m_Frame.deltaTime };
+
+	node.start = Clock::now();
+	node.function(context);
+	node.end = Clock::now();
+
+	// Queued from here the successors still count on the phase counter, which this job holds
+	for (std::uint32_t successor : node.successors)
+	{
+		if (m_Nodes[successor]->pending.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			m_Frame.jobs->Run([this, successor] { RunNode(successor); }, *m_Frame.counter);
+	}
+}
+
+/// ----------------------------------------------------------------
+/// Scheduler::BuildReport
+/// ----------------------------------------------------------------
+
+void ecs::Scheduler::BuildReport(Clock::time_point frameStart, Clock::time_point frameEnd, const std::vector<double>& syncMs)
+{
+	ScheduleReport& report = m_Report;
+
+	report.systems.resize(m_Nodes.size());
+	report.criticalPath.clear();
+	report.frameMs = Milliseconds(frameEnd - frameStart);
+	report.workMs = 0.0;
+	report.criticalPathMs = 0.0;
+	report.syncMs = 0.0;
+	report.syncPoints = static_cast<std::uint32_t>(syncMs.size());
+
+	for (std::size_t i = 0; i < m_Nodes.size(); ++i)
+	{
+		const Node& node = *m_Nodes[i];
+		ScheduleReport::SystemTiming& timing = report.systems[i];
+
+		timing.name = node.name;
+		timing.phase = node.phase;
+		timing.startMs = Milliseconds(node.start - frameStart);
+		timing.durationMs = Milliseconds(node.end - node.start);
+		timing.critical = false;
+
+		report.workMs += timing.durationMs;
+	}
+
+	// Longest chain of each phase: nodes come in dependency order, so one pass
+	std::vector<double> finish(m_Nodes.size(), 0.0);
+	std::vector<std::uint32_t> previous(m_Nodes.size(), UINT32_MAX);
+
+	for (std::size_t p = 0; p < m_Phases.size(); ++p)
+	{
+		std::uint32_t last = UINT32_MAX;
+
+		for (std::uint32_t index : m_Phases[p])
+		{
+			for (std::uint32_t predecessor : m_Nodes[index]->predecessors)
+			{
+				if (finish[predecessor] > finish[index])
+				{
+					finish[index] = finish[predecessor];
+					previous[index] = predecessor;
+				}
+			}
+
+			finish[index] += report.systems[index].durationMs;
+
+			if (last == UINT32_MAX || finish[index] > finish[last])
+				last = index;
+		}
+
+		const std::size_t phaseBegin = report.criticalPath.size();
+
+		for (std::uint32_t index = last; index != UINT32_MAX; index = previous[index])
+		{
+			report.criticalPath.push_back(index);
+			report.systems[index].critical = true;
+		}
+
+		std::reverse(report.criticalPath.begin() + phaseBegin, report.criticalPath.end());
+
+		report.criticalPathMs += (last != UINT32_MAX ? finish[last] : 0.0) + syncMs[p];
+		report.syncMs += syncMs[p];
+	}
+}
+
+/// ----------------------------------------------------------------
+/// ScheduleReport::GetBottleneck
+/// ----------------------------------------------------------------
+
+const ecs::ScheduleReport::SystemTiming* ecs::ScheduleReport::GetBottleneck() const
+{
+	const SystemTiming* bottleneck = nullptr;
+
+	for (std::size_t index : criticalPath)
+	{
+		if (!bottleneck || systems[index].durationMs > bottleneck->durationMs)
+			bottleneck = &systems[index];
+	}
+
+	return bottleneck;
+}
+
+/// ----------------------------------------------------------------
+/// ScheduleReport::Format
+/// ----------------------------------------------------------------
+
+std::string ecs::ScheduleReport::Format() const
+{
+	std::string text;
+	char line[256];
+
+	std::snprintf(line, sizeof(line), "frame %.3f ms, work %.3f ms, critical path %.3f ms (parallelism %.2f), %u sync points %.3f ms\n",
+		frameMs, workMs, criticalPathMs, GetParallelism(), syncPoints, syncMs);
+	text += line;
+
+	for (const SystemTiming& system : systems)
+	{
+		std::snprintf(line, sizeof(line), "%c %-24s phase %u  start %8.3f ms  %8.3f ms\n",
+			system.critical ? '*' : ' ', system.name.c_str(), system.phase, system.startMs, system.durationMs);
+		text += line;
+	}
+
+	if (const SystemTiming* bottleneck = GetBottleneck())
+	{
+		std::snprintf(line, sizeof(line), "bottleneck: %s\n", bottleneck->name.c_str());
+		text += line;
+	}
+
+	return text;
+}